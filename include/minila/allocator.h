@@ -0,0 +1,169 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_ALLOCATOR_H
+#define MINILA_ALLOCATOR_H
+
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <unordered_map>
+#include <vector>
+#include "constants.h"
+
+namespace minila {
+
+    // Source of the storage behind BaseArray. Blocks are aligned to MINILA_ALIGNMENT
+    // and always go back to the allocator that produced them.
+    class Allocator {
+    public:
+        virtual ~Allocator() = default;
+
+        virtual void *allocate(std::size_t bytes) = 0;
+
+        virtual void deallocate(void *block, std::size_t bytes) = 0;
+
+        // Allocator used by arrays created on the calling thread.
+        static Allocator *current();
+
+    private:
+        friend class ArenaScope;
+
+        static Allocator *&_current() {
+            thread_local Allocator *allocator = nullptr;
+            return allocator;
+        }
+    };
+
+    // Plain aligned operator new/delete; the default allocator.
+    class HeapAllocator : public Allocator {
+    public:
+        void *allocate(std::size_t bytes) override {
+            return ::operator new(bytes, std::align_val_t(MINILA_ALIGNMENT));
+        }
+
+        void deallocate(void *block, std::size_t bytes) override {
+            ::operator delete(block, bytes, std::align_val_t(MINILA_ALIGNMENT));
+        }
+
+        static HeapAllocator *instance() {
+            static HeapAllocator heap;
+            return &heap;
+        }
+    };
+
+    inline Allocator *Allocator::current() {
+        auto allocator = _current();
+        return allocator != nullptr ? allocator : HeapAllocator::instance();
+    }
+
+    constexpr std::size_t MINILA_ARENA_CAPACITY = std::size_t(64) << 20; // Default cap on bytes an arena caches.
+
+    // Recycling pool: freed blocks are cached and handed back out to later requests
+    // of the same size class instead of going through the heap. Requests are rounded
+    // up to four classes per power of two (at most 25% slack), so shapes that vary
+    // from one iteration to the next still hit the cache. Blocks freed while the
+    // cache holds capacity bytes go straight back to the heap, so it cannot grow
+    // without bound. An arena is not thread-safe, and arrays allocated from it must
+    // be destroyed before it is.
+    class Arena : public Allocator {
+    public:
+        explicit Arena(std::size_t capacity = MINILA_ARENA_CAPACITY) : _capacity(capacity) {}
+
+        Arena(const Arena &) = delete;
+
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena() override { release(); }
+
+        void *allocate(std::size_t bytes) override {
+            bytes = _round(bytes);
+            auto blocks = _free.find(bytes);
+            if (blocks != _free.end() && !blocks->second.empty()) {
+                auto block = blocks->second.back();
+                blocks->second.pop_back();
+                _cached -= bytes;
+
+                return block;
+            }
+
+            return HeapAllocator::instance()->allocate(bytes);
+        }
+
+        void deallocate(void *block, std::size_t bytes) override {
+            bytes = _round(bytes);
+            if (_cached + bytes > _capacity) {
+                HeapAllocator::instance()->deallocate(block, bytes);
+                return;
+            }
+
+            _free[bytes].push_back(block);
+            _cached += bytes;
+        }
+
+        // Returns every cached block to the heap.
+        void release() {
+            for (auto &[bytes, blocks]: _free)
+                for (auto block: blocks)
+                    HeapAllocator::instance()->deallocate(block, bytes);
+
+            _free.clear();
+            _cached = 0;
+        }
+
+        // Bytes currently cached for reuse; never more than capacity().
+        std::size_t cached() { return _cached; }
+
+        std::size_t capacity() { return _capacity; }
+
+        // Arena owned by the calling thread, alive until the thread exits.
+        static Arena &local() {
+            thread_local Arena arena;
+            return arena;
+        }
+
+    private:
+        std::unordered_map<std::size_t, std::vector<void *>> _free; // Keyed by size class.
+        std::size_t _cached = 0;
+        std::size_t _capacity;
+
+        // Size class of a request: multiples of MINILA_ALIGNMENT up to four of them,
+        // then multiples of a quarter of the power of two below.
+        static std::size_t _round(std::size_t bytes) {
+            const std::size_t step = bytes <= 4 * MINILA_ALIGNMENT ? MINILA_ALIGNMENT : std::bit_floor(bytes - 1) / 4;
+            return (bytes + step - 1) / step * step;
+        }
+    };
+
+    // Routes every BaseArray allocation on this thread through an arena (or any other
+    // Allocator) while in scope:
+    //
+    //     {
+    //         ArenaScope scope; // Uses Arena::local()
+    //         for (...) { auto C = blas::multiply(A, B); ... }
+    //     }
+    //
+    // Arena::local() keeps up to its capacity cached until the thread exits; call
+    // release() on it after a burst of large temporaries to hand that back early.
+    class ArenaScope {
+    public:
+        explicit ArenaScope(Allocator &allocator = Arena::local()) : _previous(Allocator::_current()) {
+            Allocator::_current() = &allocator;
+        }
+
+        ArenaScope(const ArenaScope &) = delete;
+
+        ArenaScope &operator=(const ArenaScope &) = delete;
+
+        ~ArenaScope() { Allocator::_current() = _previous; }
+
+    private:
+        Allocator *_previous;
+    };
+
+};
+
+#endif //MINILA_ALLOCATOR_H
@@ -8,13 +8,35 @@
 #define MINILA_BASE_H
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <new>
 #include <numeric>
 #include <stdexcept>
+#include <utility>
+#include "allocator.h"
+#include "constants.h"
+#include "expression.h"
+#include "half.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+// Bounds checks on element access are compiled in debug builds only. Define
+// MINILA_BOUNDS_CHECK to force them on, or MINILA_NO_BOUNDS_CHECK to force them off.
+#if !defined(NDEBUG) && !defined(MINILA_NO_BOUNDS_CHECK) && !defined(MINILA_BOUNDS_CHECK)
+#define MINILA_BOUNDS_CHECK
+#endif
 
 namespace minila {
 
-    template<typename T> requires std::is_arithmetic_v<T>
+    // Constructor tag for arrays whose every element the caller writes before
+    // reading: the storage is left uninitialized instead of zero-filled.
+    struct Uninitialized {
+    };
+
+    constexpr Uninitialized uninitialized{};
+
+    template<typename T> requires IsElement<T>
     class BaseArray {
     public:
 
@@ -22,15 +44,22 @@ namespace minila {
 
         // Constructors and destructors
         // Base constructor
-        BaseArray() : _data(nullptr), _dimensions(nullptr), _ndim(0), _n_elements(0) {};
+        BaseArray() : _data(nullptr), _dimensions(nullptr), _ndim(0), _n_elements(0), _allocator(nullptr) {};
 
         // Copy constructor for BaseArray
         BaseArray(const BaseArray<T> &right);
 
+        // Move constructor for BaseArray; steals buffers from right.
+        BaseArray(BaseArray<T> &&right) noexcept;
+
         // Creates empty BaseArray
         template<size_t N>
         explicit BaseArray(const uint64_t (&dimensions)[N]);
 
+        // Creates BaseArray without zero-filling it
+        template<size_t N>
+        BaseArray(const uint64_t (&dimensions)[N], Uninitialized);
+
         // Creates BaseArray with values
         template<size_t N1, size_t N2>
         BaseArray(const uint64_t (&dimensions)[N1], const T (&values)[N2]);
@@ -39,6 +68,11 @@ namespace minila {
         template<size_t N>
         BaseArray(const uint64_t (&dimensions)[N], T &value);
 
+        // Evaluates an elementwise expression in a single pass
+        template<typename E>
+        requires IsExpression<E>
+        BaseArray(const E &expression);
+
         // Virtual destructor
         virtual ~BaseArray();
 
@@ -46,51 +80,93 @@ namespace minila {
         // Gets dimensions
         uint64_t ndim();
 
-        // Gets element from BaseArray
+        // Gets element from BaseArray; bounds checked under MINILA_BOUNDS_CHECK
         template<size_t N>
         T &operator()(const uint64_t (&index)[N]);
 
+        // Gets element from BaseArray without any checks
+        template<size_t N>
+        T &at_unchecked(const uint64_t (&index)[N]);
+
         // Gets number of elements in dimension
         uint64_t operator[](uint64_t dimension);
 
+        // Gets distance, in elements, between consecutive entries of dimension
+        uint64_t stride(uint64_t dimension);
+
         // Operators
         BaseArray<T> &operator=(const BaseArray<T> &right);
 
-        BaseArray<T> operator+(const BaseArray<T> &right);
+        BaseArray<T> &operator=(BaseArray<T> &&right) noexcept;
+
+        // Evaluates expression into this array, reusing storage when shapes match.
+        template<typename E>
+        requires IsExpression<E>
+        BaseArray<T> &operator=(const E &expression);
 
-        BaseArray<T> operator-(const BaseArray<T> &right);
+        // Leaf node for elementwise expressions (see expression.h); layout tags the
+        // storage order when the array backs a column-major matrix.
+        ArrayExpression<T> expression(Layout layout = Layout::RowMajor) const;
 
         // Returns pointer to data
         T *data();
 
     private:
         T *_data;
-        uint64_t *_dimensions;
+        uint64_t *_dimensions; // Holds the _ndim dimensions followed by their _ndim (row-major) strides.
 
         // Tracking the size of multidimensional array.
         uint64_t _ndim;
         uint64_t _n_elements;
 
+        // Allocator that produced _data; it is also the one that releases it.
+        Allocator *_allocator;
+
         bool _check_dimensions(const BaseArray<T> &right);
+
+        template<typename E>
+        bool _check_dimensions(const E &expression);
+
+        template<typename E>
+        void _evaluate(const E &expression);
+
+        // Allocates the dimensions block, caching the strides after the dimensions.
+        static uint64_t *_shape(const uint64_t *dimensions, uint64_t ndim);
+
+        // Storage comes from Allocator::current(), aligned to MINILA_ALIGNMENT. It is
+        // zero-initialized unless zero is false, for callers that overwrite every element.
+        T *_allocate(uint64_t n_elements, bool zero = true);
+
+        void _release();
     };
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     BaseArray<T>::BaseArray(const BaseArray<T> &right) : BaseArray() {
         _ndim = right._ndim;
         _n_elements = right._n_elements;
 
         if (right._ndim > 0) {
-            _dimensions = new uint64_t[right._ndim];
-            std::copy(right._dimensions, right._dimensions + right._ndim, _dimensions);
+            _dimensions = _shape(right._dimensions, right._ndim);
 
-            _data = new T[right._n_elements];
+            _data = _allocate(right._n_elements, false);
             std::copy(right._data, right._data + right._n_elements, _data);
         }
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
+    BaseArray<T>::BaseArray(BaseArray<T> &&right) noexcept :
+            _data(right._data), _dimensions(right._dimensions), _ndim(right._ndim), _n_elements(right._n_elements),
+            _allocator(right._allocator) {
+        right._data = nullptr;
+        right._dimensions = nullptr;
+        right._ndim = 0;
+        right._n_elements = 0;
+    }
+
+    template<typename T>
+    requires IsElement<T>
     template<size_t N>
     BaseArray<T>::BaseArray(const uint64_t (&dimensions)[N]) : BaseArray() {
         _ndim = uint64_t(N);
@@ -99,30 +175,48 @@ namespace minila {
             _n_elements = std::accumulate(
                     std::begin(dimensions),
                     std::end(dimensions),
-                    1,
-                    std::multiplies<T>()
+                    uint64_t(1),
+                    std::multiplies<uint64_t>()
+            );
+
+            _dimensions = _shape(dimensions, N);
+
+            _data = _allocate(_n_elements);
+        }
+    }
+
+    template<typename T>
+    requires IsElement<T>
+    template<size_t N>
+    BaseArray<T>::BaseArray(const uint64_t (&dimensions)[N], Uninitialized) : BaseArray() {
+        _ndim = uint64_t(N);
+
+        if (N > 0) {
+            _n_elements = std::accumulate(
+                    std::begin(dimensions),
+                    std::end(dimensions),
+                    uint64_t(1),
+                    std::multiplies<uint64_t>()
             );
 
-            _dimensions = new uint64_t[N];
-            std::copy(std::begin(dimensions), std::end(dimensions), _dimensions);
+            _dimensions = _shape(dimensions, N);
 
-            _data = new T[_n_elements];
+            _data = _allocate(_n_elements, false);
         }
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     template<size_t N1, size_t N2>
     BaseArray<T>::BaseArray(const uint64_t (&dimensions)[N1], const T (&values)[N2]) : BaseArray(dimensions) {
-        if (_n_elements == N2) {
-            std::copy(std::begin(values), std::end(values), _data);
-        }
+        if (_n_elements != N2)
+            throw std::invalid_argument("Dimension size mismatch for operation.");
 
-        throw std::invalid_argument("Dimension size mismatch for operation.");
+        std::copy(std::begin(values), std::end(values), _data);
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     template<size_t N>
     BaseArray<T>::BaseArray(const uint64_t (&dimensions)[N], T &value) : BaseArray() {
         _ndim = uint64_t(N);
@@ -132,116 +226,155 @@ namespace minila {
             _n_elements = std::accumulate(
                     std::begin(dimensions),
                     std::end(dimensions),
-                    1,
-                    std::multiplies<T>()
+                    uint64_t(1),
+                    std::multiplies<uint64_t>()
             );
 
-            _dimensions = new uint64_t[N];
-            std::copy(std::begin(dimensions), std::end(dimensions), _dimensions);
+            _dimensions = _shape(dimensions, N);
 
-            _data = new T[_n_elements];
+            _data = _allocate(_n_elements, false);
             std::fill_n(_data, _n_elements, value);
         }
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     BaseArray<T>::~BaseArray() {
-        delete[] _data;
+        _release();
         delete[] _dimensions;
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     uint64_t BaseArray<T>::ndim() {
         return this->_ndim;
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     template<size_t N>
     T &BaseArray<T>::operator()(const uint64_t (&index)[N]) {
-        if (_ndim == N) {
-            uint64_t _index = 0;
-            for (uint64_t i = 0; i < N; i++) {
-                if (index[i] >= _dimensions[i])
-                    throw std::invalid_argument("Axis size mismatch for operation.");
-
-                uint64_t _product = 1;
-                for (uint64_t j = i + 1; j < N; j++) {
-                    _product *= _dimensions[j];
-                }
-                _index += index[i] * _product;
-            }
+#ifdef MINILA_BOUNDS_CHECK
+        if (_ndim != N)
+            throw std::invalid_argument("Index size mismatch for operation.");
 
-            return _data[_index];
-        }
+        for (uint64_t i = 0; i < N; i++)
+            if (index[i] >= _dimensions[i])
+                throw std::invalid_argument("Axis size mismatch for operation.");
+#endif
+
+        return at_unchecked(index);
+    }
+
+    template<typename T>
+    requires IsElement<T>
+    template<size_t N>
+    inline T &BaseArray<T>::at_unchecked(const uint64_t (&index)[N]) {
+        const uint64_t *strides = _dimensions + _ndim;
+
+        uint64_t _index = 0;
+        for (uint64_t i = 0; i < N; i++)
+            _index += index[i] * strides[i];
 
-        throw std::invalid_argument("Index size mismatch for operation.");
+        return _data[_index];
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     uint64_t BaseArray<T>::operator[](uint64_t dimension) {
         return _dimensions[dimension];
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
+    uint64_t BaseArray<T>::stride(uint64_t dimension) {
+        return _dimensions[_ndim + dimension];
+    }
+
+    template<typename T>
+    requires IsElement<T>
     BaseArray<T> &BaseArray<T>::operator=(const BaseArray<T> &right) {
         if (&right != this) {
-            auto new_dim = new uint64_t[right._ndim];
-            std::copy(right._dimensions, right._dimensions + right._ndim, new_dim);
+            auto new_dim = _shape(right._dimensions, right._ndim);
+            delete[] _dimensions;
             _dimensions = new_dim;
             _ndim = right._ndim;
 
-            auto new_data = new T[right._n_elements];
-            std::copy(right._data, right._data + right._n_elements, new_data);
-            _data = new_data;
-            _n_elements = right._n_elements;
+            // Reuses the current buffer when sizes match, avoiding an allocation.
+            if (_n_elements != right._n_elements) {
+                _release();
+                _data = _allocate(right._n_elements, false);
+                _n_elements = right._n_elements;
+            }
+            std::copy(right._data, right._data + right._n_elements, _data);
         }
 
         return *this;
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
-    BaseArray<T> BaseArray<T>::operator+(const BaseArray<T> &right) {
-        if (_check_dimensions(right)) {
-            std::transform(
-                    _data,
-                    _data + _n_elements,
-                    right._data,
-                    _data,
-                    std::plus<T>());
+    requires IsElement<T>
+    BaseArray<T> &BaseArray<T>::operator=(BaseArray<T> &&right) noexcept {
+        if (&right != this) {
+            _release();
+            delete[] _dimensions;
+
+            _allocator = right._allocator;
+            _data = std::exchange(right._data, nullptr);
+            _dimensions = std::exchange(right._dimensions, nullptr);
+            _ndim = std::exchange(right._ndim, 0);
+            _n_elements = std::exchange(right._n_elements, 0);
         }
 
-        throw std::invalid_argument("Dimension size mismatch for operation.");
+        return *this;
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
-    BaseArray<T> BaseArray<T>::operator-(const BaseArray<T> &right) {
-        if (_check_dimensions(right)) {
-            std::transform(
-                    _data,
-                    _data + _n_elements,
-                    right._data,
-                    _data,
-                    std::minus<T>());
+    requires IsElement<T>
+    template<typename E>
+    requires IsExpression<E>
+    BaseArray<T>::BaseArray(const E &expression) : BaseArray() {
+        _ndim = expression.ndim();
+        _n_elements = expression.size();
+
+        if (_ndim > 0) {
+            _dimensions = _shape(expression.dimensions(), _ndim);
+
+            _data = _allocate(_n_elements, false);
+            _evaluate(expression);
         }
+    }
 
-        throw std::invalid_argument("Dimension size mismatch for operation.");
+    template<typename T>
+    requires IsElement<T>
+    template<typename E>
+    requires IsExpression<E>
+    BaseArray<T> &BaseArray<T>::operator=(const E &expression) {
+        // Elementwise expressions only read index i to write index i, so it is
+        // safe to evaluate in place even when this array is one of the operands.
+        if (!_check_dimensions(expression)) {
+            *this = BaseArray<T>(expression);
+            return *this;
+        }
+
+        _evaluate(expression);
+        return *this;
+    }
+
+    template<typename T>
+    requires IsElement<T>
+    ArrayExpression<T> BaseArray<T>::expression(Layout layout) const {
+        return ArrayExpression<T>(_data, _dimensions, _ndim, _n_elements, layout);
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     T *BaseArray<T>::data() {
         return _data;
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
+    requires IsElement<T>
     inline bool BaseArray<T>::_check_dimensions(const BaseArray<T> &right) {
         if (_ndim != right._ndim)
             return false;
@@ -249,6 +382,79 @@ namespace minila {
         return std::equal(_dimensions, _dimensions + _ndim, right._dimensions);
     }
 
+    template<typename T>
+    requires IsElement<T>
+    template<typename E>
+    inline bool BaseArray<T>::_check_dimensions(const E &expression) {
+        if (_ndim != expression.ndim())
+            return false;
+
+        return std::equal(_dimensions, _dimensions + _ndim, expression.dimensions());
+    }
+
+    template<typename T>
+    requires IsElement<T>
+    template<typename E>
+    inline void BaseArray<T>::_evaluate(const E &expression) {
+        // Large arrays are split across the thread pool. A + B and A - B over plain
+        // float/double arrays go to the vector kernels.
+        ThreadPool::global().parallel_for(_n_elements, ThreadPool::grain(1), [&](uint64_t begin, uint64_t end) {
+            if constexpr (simd::IsKernelType<T>) {
+                using Leaf = ArrayExpression<T>;
+                auto n = end - begin;
+                if constexpr (std::is_same_v<E, BinaryExpression<Leaf, Leaf, std::plus<>>>) {
+                    simd::add<T>(n, expression.left().data() + begin, expression.right().data() + begin, _data + begin);
+                    return;
+                } else if constexpr (std::is_same_v<E, BinaryExpression<Leaf, Leaf, std::minus<>>>) {
+                    simd::subtract<T>(n, expression.left().data() + begin, expression.right().data() + begin,
+                                      _data + begin);
+                    return;
+                }
+            }
+
+            for (uint64_t i = begin; i < end; i++)
+                _data[i] = static_cast<T>(expression[i]);
+        });
+    }
+
+    template<typename T>
+    requires IsElement<T>
+    uint64_t *BaseArray<T>::_shape(const uint64_t *dimensions, uint64_t ndim) {
+        auto shape = new uint64_t[2 * ndim];
+        std::copy(dimensions, dimensions + ndim, shape);
+
+        uint64_t stride = 1;
+        for (uint64_t i = ndim; i > 0; i--) {
+            shape[ndim + i - 1] = stride;
+            stride *= dimensions[i - 1];
+        }
+
+        return shape;
+    }
+
+    template<typename T>
+    requires IsElement<T>
+    T *BaseArray<T>::_allocate(uint64_t n_elements, bool zero) {
+        if (n_elements == 0)
+            return nullptr;
+
+        _allocator = Allocator::current();
+        auto data = static_cast<T *>(_allocator->allocate(n_elements * sizeof(T)));
+        if (zero)
+            std::fill_n(data, n_elements, T(0));
+
+        return data;
+    }
+
+    template<typename T>
+    requires IsElement<T>
+    void BaseArray<T>::_release() {
+        if (_data != nullptr)
+            _allocator->deallocate(_data, _n_elements * sizeof(T));
+
+        _data = nullptr;
+    }
+
 };
 
 #endif //MINILA_BASE_H
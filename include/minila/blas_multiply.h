@@ -10,13 +10,65 @@
 #ifndef MINILA_MATRIX_MULTIPLY_H
 #define MINILA_MATRIX_MULTIPLY_H
 
+#include <algorithm>
 #include <cblas.h>
+#include <cmath>
+#include <functional>
+#include <mutex>
 #include <stdexcept>
+#include <type_traits>
 #include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
 #include "vector.h"
+#include "view.h"
 
 namespace minila::blas {
 
+    // Keeps OpenBLAS single-threaded while in scope, for cblas calls issued from
+    // ThreadPool tasks: the pool already occupies the cores, and letting every
+    // task fan out into OpenBLAS's own threads would oversubscribe them. Open it
+    // around the parallel region, not inside each task. The setting is
+    // process-wide, so scopes are counted: the first one to open saves the
+    // thread count and the last one to close restores it, whichever threads
+    // they run on. A no-op with other BLAS implementations.
+    class SerialScope {
+    public:
+        SerialScope() {
+#ifdef OPENBLAS_THREAD
+            std::lock_guard<std::mutex> lock(_state().mutex);
+            if (_state().depth++ == 0) {
+                _state().previous = openblas_get_num_threads();
+                openblas_set_num_threads(1);
+            }
+#endif
+        }
+
+        SerialScope(const SerialScope &) = delete;
+
+        SerialScope &operator=(const SerialScope &) = delete;
+
+        ~SerialScope() {
+#ifdef OPENBLAS_THREAD
+            std::lock_guard<std::mutex> lock(_state().mutex);
+            if (--_state().depth == 0)
+                openblas_set_num_threads(_state().previous);
+#endif
+        }
+
+    private:
+        struct _State {
+            std::mutex mutex;
+            uint64_t depth = 0; // Open scopes, across all threads.
+            int previous = 1; // Thread count to restore when the last scope closes.
+        };
+
+        static _State &_state() {
+            static _State state;
+            return state;
+        }
+    };
+
     // Vector * scalar
     template<typename T>
     Vector<T> multiply(Vector<T> &left, T right) {
@@ -65,126 +117,502 @@ namespace minila::blas {
         return result;
     }
 
-    // Vector * Vector
+    // Transpose flag that presents a view's storage to a row-major cblas call.
     template<typename T>
-    T dot(Vector<T> &left, Vector<T> &right) {
-        throw std::runtime_error("Unsupported type for blas::dot.");
+    inline CBLAS_TRANSPOSE _transpose_flag(MatrixView<T> &M) {
+        if (M.row_major())
+            return CblasNoTrans;
+        if (M.col_major())
+            return CblasTrans;
+
+        throw std::invalid_argument("blas:: functions require views with one unit stride.");
+    }
+
+    // Leading dimension of a view's storage, as expected by cblas.
+    template<typename T>
+    inline int _leading_dimension(MatrixView<T> &M) {
+        return std::max<int>(1, M.row_major() ? M.row_stride() : M.col_stride());
+    }
+
+    // C <- alpha * A * B + beta * C. Every operand may be stored in either order:
+    // the order of A and B becomes a transpose flag, and a column-major C is
+    // written as the row-major C^T = B^T * A^T, so nothing is ever copied.
+    template<typename T>
+    void _gemm(T alpha, MatrixView<T> A, MatrixView<T> B, T beta, MatrixView<T> C) {
+        throw std::runtime_error("Unsupported type for blas::multiply.");
     }
 
-    // Vector * Vector
     template<>
-    float dot(Vector<float> &left, Vector<float> &right) {
-        if (left.dimensions() != right.dimensions())
+    void _gemm(float alpha, MatrixView<float> A, MatrixView<float> B, float beta, MatrixView<float> C) {
+        if (A.cols() != B.rows() || A.rows() != C.rows() || B.cols() != C.cols())
             throw std::runtime_error("Invalid axis sizes for blas::multiply.");
 
-        return cblas_sdot(left.dimensions(), left.data(), 1, right.data(), 1);
+        if (!C.row_major()) {
+            _transpose_flag(C); // Throws for views without a unit stride.
+            return _gemm(alpha, B.transpose(), A.transpose(), beta, C.transpose());
+        }
+
+        cblas_sgemm(CblasRowMajor, _transpose_flag(A), _transpose_flag(B), C.rows(), C.cols(), A.cols(), alpha,
+                    A.data(), _leading_dimension(A), B.data(), _leading_dimension(B), beta, C.data(),
+                    _leading_dimension(C));
     }
 
-    // Vector * Vector
     template<>
-    double dot(Vector<double> &left, Vector<double> &right) {
-        if (left.dimensions() != right.dimensions())
+    void _gemm(double alpha, MatrixView<double> A, MatrixView<double> B, double beta, MatrixView<double> C) {
+        if (A.cols() != B.rows() || A.rows() != C.rows() || B.cols() != C.cols())
             throw std::runtime_error("Invalid axis sizes for blas::multiply.");
 
-        return cblas_ddot(left.dimensions(), left.data(), 1, right.data(), 1);
+        if (!C.row_major()) {
+            _transpose_flag(C); // Throws for views without a unit stride.
+            return _gemm(alpha, B.transpose(), A.transpose(), beta, C.transpose());
+        }
+
+        cblas_dgemm(CblasRowMajor, _transpose_flag(A), _transpose_flag(B), C.rows(), C.cols(), A.cols(), alpha,
+                    A.data(), _leading_dimension(A), B.data(), _leading_dimension(B), beta, C.data(),
+                    _leading_dimension(C));
     }
 
-    // Matrix * Vector
+    // y <- alpha * A * x + beta * y, for A stored in either order.
     template<typename T>
-    Vector<T> multiply(Matrix<T> &left, Vector<T> &right) {
+    void _gemv(T alpha, MatrixView<T> A, VectorView<T> x, T beta, VectorView<T> y) {
         throw std::runtime_error("Unsupported type for blas::multiply.");
     }
 
-    // Matrix * Vector
     template<>
-    Vector<float> multiply<float>(Matrix<float> &left, Vector<float> &right) {
-        if (left.cols() != right.dimensions())
+    void _gemv(float alpha, MatrixView<float> A, VectorView<float> x, float beta, VectorView<float> y) {
+        if (A.cols() != x.dimensions() || A.rows() != y.dimensions())
             throw std::runtime_error("Invalid axis sizes for blas::multiply.");
 
-        auto result = Vector<float>(left.rows()); // Initializes with zeros.
-        cblas_sgemv(CblasRowMajor, CblasNoTrans, left.rows(), left.cols(), 1.0, left.data(), left.rows(), right.data(),
-                    1, 1.0, result.data(), 1);
+        auto trans = _transpose_flag(A);
+        auto m = trans == CblasNoTrans ? A.rows() : A.cols();
+        auto n = trans == CblasNoTrans ? A.cols() : A.rows();
 
-        return result;
+        cblas_sgemv(CblasRowMajor, trans, m, n, alpha, A.data(), _leading_dimension(A), x.data(), x.stride(), beta,
+                    y.data(), y.stride());
     }
 
-    // Matrix * Vector
     template<>
-    Vector<double> multiply<double>(Matrix<double> &left, Vector<double> &right) {
-        if (left.cols() != right.dimensions())
+    void _gemv(double alpha, MatrixView<double> A, VectorView<double> x, double beta, VectorView<double> y) {
+        if (A.cols() != x.dimensions() || A.rows() != y.dimensions())
             throw std::runtime_error("Invalid axis sizes for blas::multiply.");
 
-        auto result = Vector<double>(left.rows()); // Initializes with zeros.
-        cblas_dgemv(CblasRowMajor, CblasNoTrans, left.rows(), left.cols(), 1.0, left.data(), left.rows(), right.data(),
-                    1, 1.0, result.data(), 1);
+        auto trans = _transpose_flag(A);
+        auto m = trans == CblasNoTrans ? A.rows() : A.cols();
+        auto n = trans == CblasNoTrans ? A.cols() : A.rows();
 
-        return result;
+        cblas_dgemv(CblasRowMajor, trans, m, n, alpha, A.data(), _leading_dimension(A), x.data(), x.stride(), beta,
+                    y.data(), y.stride());
     }
 
-    // Vector * Matrix
+    // Vector * Vector
     template<typename T>
-    Vector<T> multiply(Vector<T> &left, Matrix<T> &right) {
-        throw std::runtime_error("Unsupported type for blas::multiply.");
+    T dot(VectorView<T> left, VectorView<T> right) {
+        throw std::runtime_error("Unsupported type for blas::dot.");
     }
 
-    // Vector * Matrix
+    // Vector * Vector
     template<>
-    Vector<float> multiply<float>(Vector<float> &left, Matrix<float> &right) {
-        if (left.dimensions() != right.rows())
+    float dot(VectorView<float> left, VectorView<float> right) {
+        if (left.dimensions() != right.dimensions())
             throw std::runtime_error("Invalid axis sizes for blas::multiply.");
 
-        auto result = Vector<float>(right.cols()); // Initializes with zeros.
-        cblas_sgemv(CblasRowMajor, CblasTrans, right.rows(), right.cols(), 1.0, right.data(), right.rows(), left.data(),
-                    1, 1.0, result.data(), 1);
-
-        return result;
+        return cblas_sdot(left.dimensions(), left.data(), left.stride(), right.data(), right.stride());
     }
 
-    // Vector * Matrix
+    // Vector * Vector
     template<>
-    Vector<double> multiply<double>(Vector<double> &left, Matrix<double> &right) {
-        if (left.dimensions() != right.rows())
+    double dot(VectorView<double> left, VectorView<double> right) {
+        if (left.dimensions() != right.dimensions())
             throw std::runtime_error("Invalid axis sizes for blas::multiply.");
 
-        auto result = Vector<double>(right.cols()); // Initializes with zeros.
-        cblas_dgemv(CblasRowMajor, CblasTrans, right.rows(), right.cols(), 1.0, right.data(), right.rows(), left.data(),
-                    1, 1.0, result.data(), 1);
+        return cblas_ddot(left.dimensions(), left.data(), left.stride(), right.data(), right.stride());
+    }
+
+    // Vector * Vector
+    template<typename T>
+    T dot(Vector<T> &left, Vector<T> &right) {
+        return dot(left.view(), right.view());
+    }
+
+    // Level 1: in-place updates and reductions on vectors. Index results are 1-based,
+    // like element access. Only float and double are supported.
+
+    template<typename T>
+    void _level1(uint64_t left, uint64_t right) {
+        if (left != right)
+            throw std::invalid_argument("Invalid axis sizes on operation blas::level1.");
+        if constexpr (!std::is_same_v<T, float> && !std::is_same_v<T, double>)
+            throw std::runtime_error("Unsupported type for blas::level1.");
+    }
+
+    // x <- alpha * x
+    template<typename T>
+    void scal(std::type_identity_t<T> alpha, VectorView<T> x) {
+        _level1<T>(x.dimensions(), x.dimensions());
+        if constexpr (std::is_same_v<T, float>)
+            cblas_sscal(x.dimensions(), alpha, x.data(), x.stride());
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_dscal(x.dimensions(), alpha, x.data(), x.stride());
+    }
+
+    template<typename T>
+    void scal(std::type_identity_t<T> alpha, Vector<T> &x) {
+        scal(alpha, x.view());
+    }
+
+    // y <- alpha * x + y
+    template<typename T>
+    void axpy(std::type_identity_t<T> alpha, VectorView<T> x, VectorView<T> y) {
+        _level1<T>(x.dimensions(), y.dimensions());
+        if constexpr (std::is_same_v<T, float>)
+            cblas_saxpy(x.dimensions(), alpha, x.data(), x.stride(), y.data(), y.stride());
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_daxpy(x.dimensions(), alpha, x.data(), x.stride(), y.data(), y.stride());
+    }
+
+    template<typename T>
+    void axpy(std::type_identity_t<T> alpha, Vector<T> &x, Vector<T> &y) {
+        axpy(alpha, x.view(), y.view());
+    }
+
+    // y <- alpha * x + beta * y, in one pass over contiguous vectors.
+    template<typename T>
+    void axpby(std::type_identity_t<T> alpha, VectorView<T> x, std::type_identity_t<T> beta, VectorView<T> y) {
+        _level1<T>(x.dimensions(), y.dimensions());
+        if constexpr (simd::IsKernelType<T>) {
+            if (x.stride() == 1 && y.stride() == 1)
+                return simd::axpby(x.dimensions(), alpha, x.data(), beta, y.data());
+
+            scal(beta, y);
+            axpy(alpha, x, y);
+        }
+    }
+
+    template<typename T>
+    void axpby(std::type_identity_t<T> alpha, Vector<T> &x, std::type_identity_t<T> beta, Vector<T> &y) {
+        axpby(alpha, x.view(), beta, y.view());
+    }
+
+    // Euclidean norm, scaled against overflow.
+    template<typename T>
+    T nrm2(VectorView<T> x) {
+        _level1<T>(x.dimensions(), x.dimensions());
+        if constexpr (std::is_same_v<T, float>)
+            return cblas_snrm2(x.dimensions(), x.data(), x.stride());
+        else if constexpr (std::is_same_v<T, double>)
+            return cblas_dnrm2(x.dimensions(), x.data(), x.stride());
+    }
+
+    template<typename T>
+    T nrm2(Vector<T> &x) {
+        return nrm2(x.view());
+    }
+
+    // Sum of absolute values.
+    template<typename T>
+    T asum(VectorView<T> x) {
+        _level1<T>(x.dimensions(), x.dimensions());
+        if constexpr (std::is_same_v<T, float>)
+            return cblas_sasum(x.dimensions(), x.data(), x.stride());
+        else if constexpr (std::is_same_v<T, double>)
+            return cblas_dasum(x.dimensions(), x.data(), x.stride());
+    }
+
+    template<typename T>
+    T asum(Vector<T> &x) {
+        return asum(x.view());
+    }
+
+    // Index of the first element of largest absolute value; 0 for an empty vector.
+    template<typename T>
+    uint64_t iamax(VectorView<T> x) {
+        _level1<T>(x.dimensions(), x.dimensions());
+        if (x.dimensions() == 0)
+            return 0;
+
+        if constexpr (std::is_same_v<T, float>)
+            return cblas_isamax(x.dimensions(), x.data(), x.stride()) + 1;
+        else if constexpr (std::is_same_v<T, double>)
+            return cblas_idamax(x.dimensions(), x.data(), x.stride()) + 1;
+    }
+
+    template<typename T>
+    uint64_t iamax(Vector<T> &x) {
+        return iamax(x.view());
+    }
+
+    // y <- x
+    template<typename T>
+    void copy(VectorView<T> x, VectorView<T> y) {
+        _level1<T>(x.dimensions(), y.dimensions());
+        if constexpr (std::is_same_v<T, float>)
+            cblas_scopy(x.dimensions(), x.data(), x.stride(), y.data(), y.stride());
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_dcopy(x.dimensions(), x.data(), x.stride(), y.data(), y.stride());
+    }
+
+    template<typename T>
+    void copy(Vector<T> &x, Vector<T> &y) {
+        copy(x.view(), y.view());
+    }
+
+    // x <-> y
+    template<typename T>
+    void swap(VectorView<T> x, VectorView<T> y) {
+        _level1<T>(x.dimensions(), y.dimensions());
+        if constexpr (std::is_same_v<T, float>)
+            cblas_sswap(x.dimensions(), x.data(), x.stride(), y.data(), y.stride());
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_dswap(x.dimensions(), x.data(), x.stride(), y.data(), y.stride());
+    }
+
+    template<typename T>
+    void swap(Vector<T> &x, Vector<T> &y) {
+        swap(x.view(), y.view());
+    }
+
+    // Fused kernels: one sweep of memory where the unfused forms take several.
+
+    // Cosine of the angle between x and y: the dot product and both norms come
+    // from a single pass over contiguous vectors (three cblas dots otherwise).
+    // The raw sums of squares overflow or underflow far sooner than the cosine
+    // does; when either one is not a normal number, the sums are taken again
+    // with each vector scaled by its largest magnitude, as LAPACK's ?lassq does.
+    template<typename T>
+    T cosine(VectorView<T> x, VectorView<T> y) {
+        _level1<T>(x.dimensions(), y.dimensions());
+        if constexpr (simd::IsKernelType<T>) {
+            T sums[3];
+            if (x.stride() == 1 && y.stride() == 1)
+                simd::dot_norms(x.dimensions(), x.data(), y.data(), sums);
+            else
+                sums[0] = dot(x, y), sums[1] = dot(x, x), sums[2] = dot(y, y);
+
+            if (!std::isnormal(sums[1]) || !std::isnormal(sums[2])) {
+                const T scale_x = x.dimensions() ? std::abs(x(iamax(x))) : T(0);
+                const T scale_y = y.dimensions() ? std::abs(y(iamax(y))) : T(0);
+                if (scale_x > 0 && scale_y > 0 && std::isfinite(scale_x) && std::isfinite(scale_y)) {
+                    sums[0] = sums[1] = sums[2] = 0;
+                    for (uint64_t i = 1; i <= x.dimensions(); i++) {
+                        const T a = x(i) / scale_x, b = y(i) / scale_y;
+                        sums[0] += a * b;
+                        sums[1] += a * a;
+                        sums[2] += b * b;
+                    }
+                }
+            }
+
+            return sums[0] / (std::sqrt(sums[1]) * std::sqrt(sums[2]));
+        }
+    }
+
+    template<typename T>
+    T cosine(Vector<T> &x, Vector<T> &y) {
+        return cosine(x.view(), y.view());
+    }
+
+    // Angle between x and y, in radians; rounding is clamped out of the cosine.
+    template<typename T>
+    T angle(VectorView<T> x, VectorView<T> y) {
+        return std::acos(std::clamp(cosine(x, y), T(-1), T(1)));
+    }
+
+    template<typename T>
+    T angle(Vector<T> &x, Vector<T> &y) {
+        return angle(x.view(), y.view());
+    }
+
+    // Scales x to unit norm in place and returns its former norm, from nrm2 so
+    // that large entries do not overflow. A zero vector, or one whose norm is
+    // not finite, is left as is.
+    template<typename T>
+    T normalize(VectorView<T> x) {
+        _level1<T>(x.dimensions(), x.dimensions());
+        if constexpr (simd::IsKernelType<T>) {
+            const T norm = nrm2(x);
+            if (norm > 0 && std::isfinite(norm))
+                scal(T(1) / norm, x);
+
+            return norm;
+        }
+    }
+
+    template<typename T>
+    T normalize(Vector<T> &x) {
+        return normalize(x.view());
+    }
+
+    // Matrix * Vector
+    template<typename T>
+    Vector<T> multiply(MatrixView<T> left, VectorView<T> right) {
+        auto result = Vector<T>(left.rows());
+        _gemv(T(1), left, right, T(0), result.view());
 
         return result;
     }
 
-    // Matrix * Matrix
+    // Matrix * Vector
+    template<typename T, Layout L>
+    Vector<T> multiply(Matrix<T, 0, 0, L> &left, Vector<T> &right) {
+        return multiply(left.view(), right.view());
+    }
+
+    // Vector * Matrix
     template<typename T>
-    Matrix<T> multiply(Matrix<T> &left, Matrix<T> &right) {
-        throw std::runtime_error("Unsupported type for blas::multiply.");
+    Vector<T> multiply(VectorView<T> left, MatrixView<T> right) {
+        return multiply(right.transpose(), left);
+    }
+
+    // Vector * Matrix
+    template<typename T, Layout L>
+    Vector<T> multiply(Vector<T> &left, Matrix<T, 0, 0, L> &right) {
+        return multiply(left.view(), right.view());
     }
 
     // Matrix * Matrix
-    template<>
-    Matrix<float> multiply(Matrix<float> &left, Matrix<float> &right) {
-        if (left.cols() != right.rows())
-            throw std::runtime_error("Invalid axis sizes for blas::multiply.");
+    template<typename T>
+    Matrix<T> multiply(MatrixView<T> left, MatrixView<T> right) {
+        auto C = Matrix<T>(left.rows(), right.cols());
+        _gemm(T(1), left, right, T(0), C.view());
+
+        return C;
+    }
 
-        auto C = Matrix<float>(left.rows(), right.cols());
-        cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, left.rows(), right.cols(), left.cols(), 1.0, left.data(),
-                    left.rows(), right.data(), right.rows(), 1.0, C.data(), left.rows());
+    // Matrix * Matrix; the result is stored in the layout of left.
+    template<typename T, Layout L1, Layout L2>
+    Matrix<T, 0, 0, L1> multiply(Matrix<T, 0, 0, L1> &left, Matrix<T, 0, 0, L2> &right) {
+        auto C = Matrix<T, 0, 0, L1>(left.rows(), right.cols());
+        _gemm(T(1), left.view(), right.view(), T(0), C.view());
 
         return C;
     }
 
-    // Matrix * Matrix
-    template<>
-    Matrix<double> multiply(Matrix<double> &left, Matrix<double> &right) {
-        if (left.cols() != right.rows())
-            throw std::runtime_error("Invalid axis sizes for blas::multiply.");
+    // Transposed operands: transpose(A) reaches cblas as a CblasTrans flag on A's
+    // own storage. Results are stored in the layout of the (underlying) left matrix.
+
+    // Matrix^T * Matrix
+    template<typename T, Layout L1, Layout L2>
+    Matrix<T, 0, 0, L1> multiply(Transpose<Matrix<T, 0, 0, L1>> left, Matrix<T, 0, 0, L2> &right) {
+        auto C = Matrix<T, 0, 0, L1>(left.rows(), right.cols());
+        _gemm(T(1), left.view(), right.view(), T(0), C.view());
+
+        return C;
+    }
+
+    // Matrix * Matrix^T
+    template<typename T, Layout L1, Layout L2>
+    Matrix<T, 0, 0, L1> multiply(Matrix<T, 0, 0, L1> &left, Transpose<Matrix<T, 0, 0, L2>> right) {
+        auto C = Matrix<T, 0, 0, L1>(left.rows(), right.cols());
+        _gemm(T(1), left.view(), right.view(), T(0), C.view());
+
+        return C;
+    }
 
-        auto C = Matrix<double>(left.rows(), right.cols());
-        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, left.rows(), right.cols(), left.cols(), 1.0, left.data(),
-                    left.rows(), right.data(), right.rows(), 1.0, C.data(), left.rows());
+    // Matrix^T * Matrix^T
+    template<typename T, Layout L1, Layout L2>
+    Matrix<T, 0, 0, L1> multiply(Transpose<Matrix<T, 0, 0, L1>> left, Transpose<Matrix<T, 0, 0, L2>> right) {
+        auto C = Matrix<T, 0, 0, L1>(left.rows(), right.cols());
+        _gemm(T(1), left.view(), right.view(), T(0), C.view());
 
         return C;
     }
 
+    // Matrix^T * Vector
+    template<typename T, Layout L>
+    Vector<T> multiply(Transpose<Matrix<T, 0, 0, L>> left, Vector<T> &right) {
+        return multiply(left.view(), right.view());
+    }
+
+    // Vector * Matrix^T
+    template<typename T, Layout L>
+    Vector<T> multiply(Vector<T> &left, Transpose<Matrix<T, 0, 0, L>> right) {
+        return multiply(left.view(), right.view());
+    }
+
+    // Whether the storage spans [data, last element] of two views intersect. Spans
+    // are conservative: interleaved views (say, two columns of one row-major
+    // matrix) count as overlapping even if no element is shared.
+    template<typename T>
+    bool _overlap(T *x, uint64_t x_extent, T *y, uint64_t y_extent) {
+        if (x == nullptr || y == nullptr || x_extent == 0 || y_extent == 0)
+            return false;
+
+        return std::less<T *>()(x, y + y_extent) && std::less<T *>()(y, x + x_extent);
+    }
+
+    // Elements from data() to the last element of a view, inclusive.
+    template<typename T>
+    uint64_t _extent(MatrixView<T> &M) {
+        if (M.rows() == 0 || M.cols() == 0)
+            return 0;
+
+        return (M.rows() - 1) * M.row_stride() + (M.cols() - 1) * M.col_stride() + 1;
+    }
+
+    template<typename T>
+    uint64_t _extent(VectorView<T> &v) {
+        return v.dimensions() == 0 ? 0 : (v.dimensions() - 1) * v.stride() + 1;
+    }
+
+    // C <- alpha * A * B + beta * C, into caller-owned storage: nothing is allocated,
+    // and beta = 1 accumulates the product onto C. The storage span of C must not
+    // overlap that of A or B.
+    template<typename T>
+    void gemm_into(MatrixView<T> C, MatrixView<T> A, MatrixView<T> B, std::type_identity_t<T> alpha = 1,
+                   std::type_identity_t<T> beta = 0) {
+        if (_overlap(C.data(), _extent(C), A.data(), _extent(A)) ||
+            _overlap(C.data(), _extent(C), B.data(), _extent(B)))
+            throw std::invalid_argument("Output of blas::gemm_into aliases an input.");
+
+        _gemm(alpha, A, B, beta, C);
+    }
+
+    template<typename T, Layout LC, Layout LA, Layout LB>
+    void gemm_into(Matrix<T, 0, 0, LC> &C, Matrix<T, 0, 0, LA> &A, Matrix<T, 0, 0, LB> &B,
+                   std::type_identity_t<T> alpha = 1, std::type_identity_t<T> beta = 0) {
+        gemm_into(C.view(), A.view(), B.view(), alpha, beta);
+    }
+
+    // y <- alpha * A * x + beta * y, into caller-owned storage. The storage span
+    // of y must not overlap that of A or x.
+    template<typename T>
+    void gemv_into(VectorView<T> y, MatrixView<T> A, VectorView<T> x, std::type_identity_t<T> alpha = 1,
+                   std::type_identity_t<T> beta = 0) {
+        if (_overlap(y.data(), _extent(y), A.data(), _extent(A)) ||
+            _overlap(y.data(), _extent(y), x.data(), _extent(x)))
+            throw std::invalid_argument("Output of blas::gemv_into aliases an input.");
+
+        _gemv(alpha, A, x, beta, y);
+    }
+
+    template<typename T, Layout L>
+    void gemv_into(Vector<T> &y, Matrix<T, 0, 0, L> &A, Vector<T> &x, std::type_identity_t<T> alpha = 1,
+                   std::type_identity_t<T> beta = 0) {
+        gemv_into(y.view(), A.view(), x.view(), alpha, beta);
+    }
+
+    // Unevaluated alpha * left * right, consumed by the fused += and -= operators
+    // in operator_performance.h (C += blas::product(A, B) runs a single gemm with
+    // beta = 1). Holds references, so use it within the statement that builds it.
+    template<typename L, typename R, typename T>
+    struct Product {
+        L &left;
+        R &right;
+        T alpha;
+    };
+
+    template<typename T, Layout L1, Layout L2>
+    Product<Matrix<T, 0, 0, L1>, Matrix<T, 0, 0, L2>, T>
+    product(Matrix<T, 0, 0, L1> &left, Matrix<T, 0, 0, L2> &right, std::type_identity_t<T> alpha = 1) {
+        return {left, right, alpha};
+    }
+
+    template<typename T, Layout L>
+    Product<Matrix<T, 0, 0, L>, Vector<T>, T>
+    product(Matrix<T, 0, 0, L> &left, Vector<T> &right, std::type_identity_t<T> alpha = 1) {
+        return {left, right, alpha};
+    }
+
 };
 
 #endif //MINILA_MATRIX_MULTIPLY_H
@@ -0,0 +1,162 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_BLOCKED_H
+#define MINILA_BLOCKED_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "vector.h"
+#include "view.h"
+
+namespace minila::blocked {
+
+    // Dependency-free GEMM, organised like the GotoBLAS/BLIS kernels: B is packed
+    // in KC x NC blocks sized for L3, A in MC x KC blocks sized for L2, and the
+    // simd::gemm microkernel sweeps MR x NR register tiles over them from L1.
+    // bf16/fp16 operands are widened to float while packing, so 16-bit matrices
+    // run the float kernel at half the memory traffic and accumulate in float.
+    constexpr uint64_t MINILA_GEMM_KC = 256;  // Depth of a packed panel.
+    constexpr uint64_t MINILA_GEMM_MC = 144;  // Rows of A packed at once; a multiple of every MR.
+    constexpr uint64_t MINILA_GEMM_NC = 4096; // Columns of B packed at once; a multiple of every NR.
+
+    // Copies the mc x kc block of A at (row, col) into MR-row panels, each stored
+    // column by column. Rows past the edge are zero padded.
+    template<typename S, typename T>
+    void _pack_a(MatrixView<S> &A, uint64_t row, uint64_t col, uint64_t mc, uint64_t kc, uint64_t mr, T *packed) {
+        const S *data = A.data();
+        const uint64_t rs = A.row_stride(), cs = A.col_stride();
+
+        for (uint64_t panel = 0; panel < mc; panel += mr) {
+            const uint64_t rows = std::min(mr, mc - panel);
+            for (uint64_t k = 0; k < kc; k++) {
+                const S *source = data + (row + panel) * rs + (col + k) * cs;
+                for (uint64_t r = 0; r < rows; r++)
+                    packed[r] = T(source[r * rs]);
+                std::fill(packed + rows, packed + mr, T(0));
+                packed += mr;
+            }
+        }
+    }
+
+    // Copies the kc x nc block of B at (row, col) into NR-column panels, each
+    // stored row by row. Columns past the edge are zero padded.
+    template<typename S, typename T>
+    void _pack_b(MatrixView<S> &B, uint64_t row, uint64_t col, uint64_t kc, uint64_t nc, uint64_t nr, T *packed) {
+        const S *data = B.data();
+        const uint64_t rs = B.row_stride(), cs = B.col_stride();
+
+        for (uint64_t panel = 0; panel < nc; panel += nr) {
+            const uint64_t cols = std::min(nr, nc - panel);
+            for (uint64_t k = 0; k < kc; k++) {
+                const S *source = data + (row + k) * rs + (col + panel) * cs;
+                for (uint64_t c = 0; c < cols; c++)
+                    packed[c] = T(source[c * cs]);
+                std::fill(packed + cols, packed + nr, T(0));
+                packed += nr;
+            }
+        }
+    }
+
+    template<typename T, typename ISA, typename S>
+    void _gemm(T alpha, MatrixView<S> &A, MatrixView<S> &B, T beta, MatrixView<T> &C) {
+        constexpr uint64_t MR = ISA::gemm_mr, NR = ISA::template gemm_nr<T>;
+        const uint64_t m = C.rows(), n = C.cols(), p = A.cols();
+        const uint64_t rs = C.row_stride(), cs = C.col_stride();
+
+        // Workspaces come from Allocator::current(), so an ArenaScope recycles them.
+        const uint64_t kc_max = std::min(MINILA_GEMM_KC, p);
+        Vector<T> packed_a(std::min(MINILA_GEMM_MC, (m + MR - 1) / MR * MR) * kc_max);
+        Vector<T> packed_b(std::min(MINILA_GEMM_NC, (n + NR - 1) / NR * NR) * kc_max);
+
+        for (uint64_t jc = 0; jc < n; jc += MINILA_GEMM_NC) {
+            const uint64_t nc = std::min(MINILA_GEMM_NC, n - jc);
+
+            for (uint64_t pc = 0; pc < p; pc += MINILA_GEMM_KC) {
+                const uint64_t kc = std::min(MINILA_GEMM_KC, p - pc);
+                const T scale = pc == 0 ? beta : T(1); // beta applies once, on the first panel.
+                _pack_b(B, pc, jc, kc, nc, NR, packed_b.data());
+
+                for (uint64_t ic = 0; ic < m; ic += MINILA_GEMM_MC) {
+                    const uint64_t mc = std::min(MINILA_GEMM_MC, m - ic);
+                    _pack_a(A, ic, pc, mc, kc, MR, packed_a.data());
+
+                    // NR-wide column panels write disjoint parts of C, so they are
+                    // split across the pool; the packed blocks are shared read-only.
+                    const uint64_t panels = (nc + NR - 1) / NR;
+                    const uint64_t grain = ThreadPool::grain(2 * mc * kc * NR);
+                    ThreadPool::global().parallel_for(panels, grain, [&](uint64_t first, uint64_t last) {
+                        T tile[MR * NR];
+                        for (uint64_t jr = first * NR; jr < std::min(nc, last * NR); jr += NR)
+                            for (uint64_t ir = 0; ir < mc; ir += MR) {
+                                ISA::template gemm<T>(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc,
+                                                      tile);
+
+                                const uint64_t rows = std::min(MR, mc - ir), cols = std::min(NR, nc - jr);
+                                T *c = C.data() + (ic + ir) * rs + (jc + jr) * cs;
+                                for (uint64_t r = 0; r < rows; r++)
+                                    for (uint64_t j = 0; j < cols; j++) {
+                                        T &element = c[r * rs + j * cs];
+                                        // beta == 0 overwrites C, so NaNs in it do not leak through.
+                                        element = scale == T(0) ? alpha * tile[r * NR + j]
+                                                                : alpha * tile[r * NR + j] + scale * element;
+                                    }
+                            }
+                    });
+                }
+            }
+        }
+    }
+
+    // C <- alpha * A * B + beta * C, for views in any storage order (including
+    // transposed or strided ones, which are absorbed by the packing). A and B
+    // may also be bf16/fp16 views when C is float.
+    template<typename T, typename S>
+    requires std::is_same_v<S, T> || (IsHalf<S> && std::is_same_v<T, float>)
+    void gemm(T alpha, MatrixView<S> A, MatrixView<S> B, T beta, MatrixView<T> C) {
+        if (A.cols() != B.rows() || A.rows() != C.rows() || B.cols() != C.cols())
+            throw std::runtime_error("Invalid axis sizes for blocked::multiply.");
+
+        if constexpr (!simd::IsKernelType<T>)
+            throw std::runtime_error("Unsupported type for blocked::multiply.");
+        else {
+            if (A.cols() == 0) {
+                for (uint64_t i = 1; i <= C.rows(); i++)
+                    for (uint64_t j = 1; j <= C.cols(); j++)
+                        C(i, j) = beta == T(0) ? T(0) : beta * C(i, j);
+                return;
+            }
+
+            simd::_dispatch([&]<typename ISA>() { _gemm<T, ISA>(alpha, A, B, beta, C); });
+        }
+    }
+
+    // Matrix * Matrix; the result is stored in the layout of left.
+    template<typename T, Layout L1, Layout L2>
+    Matrix<T, 0, 0, L1> multiply(Matrix<T, 0, 0, L1> &left, Matrix<T, 0, 0, L2> &right) {
+        auto C = Matrix<T, 0, 0, L1>(left.rows(), right.cols());
+        gemm(T(1), left.view(), right.view(), T(0), C.view());
+
+        return C;
+    }
+
+    // bf16/fp16 Matrix * Matrix, accumulated and returned in float.
+    template<typename H, Layout L1, Layout L2>
+    requires IsHalf<H>
+    Matrix<float, 0, 0, L1> multiply(Matrix<H, 0, 0, L1> &left, Matrix<H, 0, 0, L2> &right) {
+        auto C = Matrix<float, 0, 0, L1>(left.rows(), right.cols());
+        gemm(1.0f, left.view(), right.view(), 0.0f, C.view());
+
+        return C;
+    }
+
+};
+
+#endif //MINILA_BLOCKED_H
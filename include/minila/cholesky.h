@@ -0,0 +1,121 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_CHOLESKY_H
+#define MINILA_CHOLESKY_H
+
+#include <algorithm>
+#include <lapacke.h>
+#include <stdexcept>
+#include <type_traits>
+#include "layout.h"
+#include "matrix.h"
+#include "vector.h"
+
+namespace minila {
+
+    // Cholesky factorization A = U^T U of a symmetric positive definite matrix,
+    // about half the flops of LU. Only the upper triangle of A is read.
+    template<typename T, Layout L = Layout::RowMajor>
+    struct Cholesky {
+        Matrix<T, 0, 0, L> D; // Upper triangular factor U; zero below the diagonal
+
+        int info = 0; // > 0 when the leading minor of that order is not positive definite
+
+        // Solves A x = b through ?potrs, reusing the factor.
+        Vector<T> solve(Vector<T> &b);
+
+        // Solves A X = B for all columns of B at once; X has the layout of B.
+        template<Layout LB>
+        Matrix<T, 0, 0, LB> solve(Matrix<T, 0, 0, LB> &B);
+
+        // Square of the product of U's diagonal.
+        T det();
+
+    private:
+        void _solve(uint64_t nrhs, T *B, uint64_t ldb);
+    };
+
+    // Column-major matrices are factored in place by LAPACK. Row-major ones go
+    // through the LAPACKE row-major interface, which transposes internally.
+    template<typename T, Layout L>
+    Cholesky<T, L> cholesky(Matrix<T, 0, 0, L> &M) {
+        if (M.rows() != M.cols())
+            throw std::invalid_argument("Invalid axis sizes on operation cholesky.");
+
+        auto D = Matrix(M);
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int info;
+        if constexpr (std::is_same_v<T, float>)
+            info = LAPACKE_spotrf(layout, 'U', D.rows(), D.data(), D.leading_dimension());
+        else if constexpr (std::is_same_v<T, double>)
+            info = LAPACKE_dpotrf(layout, 'U', D.rows(), D.data(), D.leading_dimension());
+        else
+            throw std::runtime_error("Unsupported type for Cholesky.");
+
+        for (uint64_t i = 2; i <= D.rows(); i++)
+            for (uint64_t j = 1; j < i; j++)
+                D.at_unchecked(i, j) = T(0);
+
+        return Cholesky<T, L>{std::move(D), info};
+    }
+
+    // B <- A^-1 B for nrhs right-hand sides stored in the layout of D.
+    template<typename T, Layout L>
+    void Cholesky<T, L>::_solve(uint64_t nrhs, T *B, uint64_t ldb) {
+        if (info != 0)
+            throw std::runtime_error("Matrix not positive definite in Cholesky::solve.");
+
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int result;
+        if constexpr (std::is_same_v<T, float>)
+            result = LAPACKE_spotrs(layout, 'U', D.rows(), nrhs, D.data(), D.leading_dimension(), B, ldb);
+        else if constexpr (std::is_same_v<T, double>)
+            result = LAPACKE_dpotrs(layout, 'U', D.rows(), nrhs, D.data(), D.leading_dimension(), B, ldb);
+        else
+            throw std::runtime_error("Unsupported type for Cholesky.");
+
+        if (result != 0)
+            throw std::runtime_error("LAPACK error in Cholesky::solve.");
+    }
+
+    template<typename T, Layout L>
+    Vector<T> Cholesky<T, L>::solve(Vector<T> &b) {
+        if (D.rows() != b.dimensions())
+            throw std::invalid_argument("Invalid axis sizes on operation Cholesky::solve.");
+
+        auto x = Vector<T>(b);
+        _solve(1, x.data(), L == Layout::ColMajor ? std::max<uint64_t>(1, x.dimensions()) : 1);
+
+        return x;
+    }
+
+    template<typename T, Layout L>
+    template<Layout LB>
+    Matrix<T, 0, 0, LB> Cholesky<T, L>::solve(Matrix<T, 0, 0, LB> &B) {
+        if (D.rows() != B.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation Cholesky::solve.");
+
+        auto X = to_layout<L>(B);
+        _solve(X.cols(), X.data(), X.leading_dimension());
+
+        return to_layout<LB>(X);
+    }
+
+    template<typename T, Layout L>
+    T Cholesky<T, L>::det() {
+        T result = 1;
+        for (uint64_t i = 1; i <= D.rows(); i++)
+            result *= D.at_unchecked(i, i);
+
+        return result * result;
+    }
+
+};
+
+#endif //MINILA_CHOLESKY_H
@@ -7,8 +7,14 @@
 #ifndef MINILA_CONSTANTS_H
 #define MINILA_CONSTANTS_H
 
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
 namespace minila {
 
+    constexpr std::size_t MINILA_ALIGNMENT = 64; // Byte alignment of array storage (one cache line).
+
     double_t MINILA_SVD_RANK = 1e-6; // Minimum singular value to be considered numerically != 0.
 
 };
@@ -0,0 +1,239 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_DISPATCH_H
+#define MINILA_DISPATCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "blas_multiply.h"
+#include "blocked.h"
+#include "matrix.h"
+#include "naive.h"
+#include "simd.h"
+#include "vector.h"
+
+namespace minila::dispatch {
+
+    // Size-aware choice between the naive, blocked and blas backends. Products
+    // are routed by their work (multiply-adds) against crossover thresholds.
+    // autotune() measures the crossovers on this machine and caches them in a
+    // file, which later processes load on first use. Only float/double operands
+    // of one type have a choice; anything else takes the naive backend.
+    struct Thresholds {
+        uint64_t gemm_blocked = 24 * 24 * 24; // Matrix * Matrix: naive below, blocked from here...
+        uint64_t gemm_blas = 512 * 512 * 512; // ...and blas from here.
+        uint64_t gemv_blas = 256 * 256;       // Matrix * Vector, Vector * Matrix: naive below, blas from here.
+        uint64_t dot_blas = 1 << 20;          // Vector * Vector: naive below, blas from here.
+    };
+
+    // Cache file: the MINILA_TUNE_FILE environment variable, or .minila_tune in
+    // the working directory.
+    inline std::string tune_file() {
+        if (auto variable = std::getenv("MINILA_TUNE_FILE"))
+            return variable;
+
+        return ".minila_tune";
+    }
+
+    // Reads "name value" lines into thresholds; unknown names are ignored.
+    // Returns false when the file cannot be opened.
+    inline bool load(Thresholds &thresholds, const std::string &path = tune_file()) {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        std::string name;
+        uint64_t value;
+        while (file >> name >> value) {
+            if (name == "gemm_blocked") thresholds.gemm_blocked = value;
+            else if (name == "gemm_blas") thresholds.gemm_blas = value;
+            else if (name == "gemv_blas") thresholds.gemv_blas = value;
+            else if (name == "dot_blas") thresholds.dot_blas = value;
+        }
+
+        return true;
+    }
+
+    inline void save(const Thresholds &thresholds, const std::string &path = tune_file()) {
+        std::ofstream file(path);
+        if (!file)
+            throw std::runtime_error("Could not write tuning file " + path + ".");
+
+        file << "gemm_blocked " << thresholds.gemm_blocked << "\n"
+             << "gemm_blas " << thresholds.gemm_blas << "\n"
+             << "gemv_blas " << thresholds.gemv_blas << "\n"
+             << "dot_blas " << thresholds.dot_blas << "\n";
+    }
+
+    // Thresholds in use: the defaults, overridden by the cache file if there is
+    // one. Must not be changed while products are running.
+    inline Thresholds &thresholds() {
+        static Thresholds thresholds = [] {
+            Thresholds loaded;
+            load(loaded);
+            return loaded;
+        }();
+
+        return thresholds;
+    }
+
+    // Best of a few runs, in seconds; each run repeats f until it takes about 1ms.
+    template<typename F>
+    double _time(F &&f) {
+        using clock = std::chrono::steady_clock;
+
+        double best = 1e300;
+        for (int run = 0; run < 3; run++) {
+            uint64_t repeats = 0;
+            auto start = clock::now();
+            std::chrono::duration<double> elapsed{};
+            do {
+                f();
+                repeats++;
+                elapsed = clock::now() - start;
+            } while (elapsed.count() < 1e-3);
+            best = std::min(best, elapsed.count() / double(repeats));
+        }
+
+        return best;
+    }
+
+    // Smallest work from which faster[i] stays true for every larger size; sizes
+    // past the last measured one keep the last result.
+    inline uint64_t _crossover(const std::vector<uint64_t> &work, const std::vector<bool> &faster) {
+        uint64_t threshold = UINT64_MAX;
+        for (uint64_t i = work.size(); i > 0 && faster[i - 1]; i--)
+            threshold = work[i - 1];
+
+        return threshold;
+    }
+
+    // Times the backends on square double problems of growing size, stores the
+    // crossovers in thresholds() and writes them to path. Takes a few seconds.
+    inline Thresholds autotune(const std::string &path = tune_file()) {
+        Thresholds result;
+
+        {
+            std::vector<uint64_t> work;
+            std::vector<bool> blocked_faster, blas_faster;
+            for (uint64_t n: {8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512}) {
+                Matrix<double> A(n, n), B(n, n);
+                std::fill_n(A.data(), n * n, 1.0);
+                std::fill_n(B.data(), n * n, 1.0);
+
+                const double naive_time = _time([&] { naive::multiply(A, B); });
+                const double blocked_time = _time([&] { blocked::multiply(A, B); });
+                const double blas_time = _time([&] { blas::multiply(A, B); });
+
+                work.push_back(n * n * n);
+                blocked_faster.push_back(blocked_time < naive_time);
+                blas_faster.push_back(blas_time < std::min(naive_time, blocked_time));
+            }
+            result.gemm_blocked = _crossover(work, blocked_faster);
+            result.gemm_blas = _crossover(work, blas_faster);
+        }
+
+        {
+            std::vector<uint64_t> work;
+            std::vector<bool> blas_faster;
+            for (uint64_t n: {16, 32, 64, 128, 256, 512, 1024, 2048}) {
+                Matrix<double> A(n, n);
+                Vector<double> x(n);
+                std::fill_n(A.data(), n * n, 1.0);
+                std::fill_n(x.data(), n, 1.0);
+
+                const double naive_time = _time([&] { naive::multiply(A, x); });
+                const double blas_time = _time([&] { blas::multiply(A, x); });
+
+                work.push_back(n * n);
+                blas_faster.push_back(blas_time < naive_time);
+            }
+            result.gemv_blas = _crossover(work, blas_faster);
+        }
+
+        {
+            std::vector<uint64_t> work;
+            std::vector<bool> blas_faster;
+            for (uint64_t n = 1 << 8; n <= 1 << 22; n <<= 2) {
+                Vector<double> x(n), y(n);
+                std::fill_n(x.data(), n, 1.0);
+                std::fill_n(y.data(), n, 1.0);
+
+                volatile double sink;
+                const double naive_time = _time([&] { sink = naive::dot(x, y); });
+                const double blas_time = _time([&] { sink = blas::dot(x, y); });
+
+                work.push_back(n);
+                blas_faster.push_back(blas_time < naive_time);
+            }
+            result.dot_blas = _crossover(work, blas_faster);
+        }
+
+        thresholds() = result;
+        save(result, path);
+
+        return result;
+    }
+
+    template<typename T1, typename T2>
+    concept IsDispatched = std::is_same_v<T1, T2> && simd::IsKernelType<T1>;
+
+    // Vector * Vector
+    template<typename T1, typename T2>
+    auto dot(Vector<T1> &left, Vector<T2> &right) {
+        if constexpr (IsDispatched<T1, T2>)
+            if (left.dimensions() == right.dimensions() && left.dimensions() >= thresholds().dot_blas)
+                return blas::dot(left, right);
+
+        return naive::dot(left, right);
+    }
+
+    // Matrix * Vector
+    template<typename T1, typename T2>
+    auto multiply(Matrix<T1> &M, Vector<T2> &v) {
+        if constexpr (IsDispatched<T1, T2>)
+            if (M.cols() == v.dimensions() && M.rows() * M.cols() >= thresholds().gemv_blas)
+                return blas::multiply(M, v);
+
+        return naive::multiply(M, v);
+    }
+
+    // Vector * Matrix
+    template<typename T1, typename T2>
+    auto multiply(Vector<T1> &v, Matrix<T2> &M) {
+        if constexpr (IsDispatched<T1, T2>)
+            if (v.dimensions() == M.rows() && M.rows() * M.cols() >= thresholds().gemv_blas)
+                return blas::multiply(v, M);
+
+        return naive::multiply(v, M);
+    }
+
+    // Matrix * Matrix
+    template<typename T1, typename T2>
+    auto multiply(Matrix<T1> &left, Matrix<T2> &right) {
+        if constexpr (IsDispatched<T1, T2>)
+            if (left.cols() == right.rows()) {
+                const uint64_t work = left.rows() * left.cols() * right.cols();
+                if (work >= thresholds().gemm_blas)
+                    return blas::multiply(left, right);
+                if (work >= thresholds().gemm_blocked)
+                    return blocked::multiply(left, right);
+            }
+
+        return naive::multiply(left, right);
+    }
+
+};
+
+#endif //MINILA_DISPATCH_H
@@ -0,0 +1,142 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_EIGEN_H
+#define MINILA_EIGEN_H
+
+#include <algorithm>
+#include <lapacke.h>
+#include <stdexcept>
+#include <type_traits>
+#include "layout.h"
+#include "matrix.h"
+#include "vector.h"
+
+namespace minila {
+
+    template<typename T, Layout L = Layout::RowMajor>
+    struct Eigen {
+        Vector<T> values; // K eigenvalues in ascending order
+        Matrix<T, 0, 0, L> vectors; // NxK, column i pairs with values(i); empty for values only
+
+        int info = 0; // Return code for eigen function
+    };
+
+    // Which eigenpairs to compute: all of them (?syevd, divide and conquer), or
+    // a subset by position in ascending order or by value (?syevr, MRRR), which
+    // costs O(N^2) per extra pair once the matrix is tridiagonal.
+    enum class EigenRange {
+        All,
+        Index,
+        Value
+    };
+
+    struct EigenOptions {
+        bool vectors = true; // Values only when false.
+        EigenRange range = EigenRange::All;
+        uint64_t first = 1, last = 1; // 1-based positions for Index: the top k of N are N-k+1..N.
+        double lower = 0, upper = 0; // Half-open interval (lower, upper] for Value.
+    };
+
+    // LAPACK workspace, reusable across calls: its size is queried (lwork = -1)
+    // on each call, which costs no flops, and the storage only ever grows.
+    template<typename T>
+    struct EigenWorkspace {
+        Vector<T> work;
+        Vector<int> iwork;
+        Vector<int> isuppz;
+    };
+
+    // Eigenpairs of a symmetric matrix; only its upper triangle is read. Row-major
+    // matrices go through the LAPACKE row-major interface, which transposes
+    // internally; use Layout::ColMajor (or to_layout) for large problems.
+    template<typename T, Layout L>
+    Eigen<T, L> eig_sym(Matrix<T, 0, 0, L> &M, EigenOptions options, EigenWorkspace<T> &workspace) {
+        if constexpr (!std::is_same_v<T, float> && !std::is_same_v<T, double>)
+            throw std::runtime_error("Unsupported type for eig_sym.");
+
+        const uint64_t n = M.rows();
+        if (M.cols() != n)
+            throw std::invalid_argument("Invalid axis sizes on operation eig_sym.");
+        if (options.range == EigenRange::Index && (options.first < 1 || options.first > options.last ||
+                                                   options.last > n))
+            throw std::invalid_argument("Invalid index range on operation eig_sym.");
+
+        //To be unmercifully destroyed.
+        Matrix<T, 0, 0, L> _temp(M);
+
+        const char jobz = options.vectors ? 'V' : 'N';
+        const auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+        const bool all = options.range == EigenRange::All;
+
+        // Every value fits in n slots; vector columns are known in advance only by index.
+        Vector<T> w(n);
+        Matrix<T, 0, 0, L> Z;
+        if (options.vectors && !all)
+            Z = Matrix<T, 0, 0, L>(n, options.range == EigenRange::Index ? options.last - options.first + 1 : n);
+        if (!all && workspace.isuppz.dimensions() < 2 * std::max<uint64_t>(1, n))
+            workspace.isuppz = Vector<int>(2 * std::max<uint64_t>(1, n));
+
+        const char range = options.range == EigenRange::Index ? 'I' : 'V';
+        const T lower = T(options.lower), upper = T(options.upper);
+        int found = int(n);
+
+        // lwork = liwork = -1 only writes the optimal sizes to *work and *iwork.
+        auto call = [&](T *work, int lwork, int *iwork, int liwork) {
+            if constexpr (std::is_same_v<T, float>) {
+                if (all)
+                    return LAPACKE_ssyevd_work(layout, jobz, 'U', n, _temp.data(), _temp.leading_dimension(),
+                                               w.data(), work, lwork, iwork, liwork);
+                return LAPACKE_ssyevr_work(layout, jobz, range, 'U', n, _temp.data(), _temp.leading_dimension(),
+                                           lower, upper, options.first, options.last, 0.0f, &found, w.data(),
+                                           Z.data(), Z.leading_dimension(), workspace.isuppz.data(), work, lwork,
+                                           iwork, liwork);
+            } else if constexpr (std::is_same_v<T, double>) {
+                if (all)
+                    return LAPACKE_dsyevd_work(layout, jobz, 'U', n, _temp.data(), _temp.leading_dimension(),
+                                               w.data(), work, lwork, iwork, liwork);
+                return LAPACKE_dsyevr_work(layout, jobz, range, 'U', n, _temp.data(), _temp.leading_dimension(),
+                                           lower, upper, options.first, options.last, 0.0, &found, w.data(),
+                                           Z.data(), Z.leading_dimension(), workspace.isuppz.data(), work, lwork,
+                                           iwork, liwork);
+            }
+            return 0;
+        };
+
+        T size = 0;
+        int isize = 0;
+        int info = n == 0 ? 0 : call(&size, -1, &isize, -1);
+        if (n > 0 && info == 0) {
+            if (workspace.work.dimensions() < uint64_t(size))
+                workspace.work = Vector<T>(uint64_t(size));
+            if (workspace.iwork.dimensions() < uint64_t(isize))
+                workspace.iwork = Vector<int>(uint64_t(isize));
+            info = call(workspace.work.data(), std::max<int>(1, workspace.work.dimensions()),
+                        workspace.iwork.data(), std::max<int>(1, workspace.iwork.dimensions()));
+        }
+        if (info != 0 || n == 0)
+            return Eigen<T, L>{Vector<T>(), Matrix<T, 0, 0, L>(), info};
+
+        // ?syevd leaves the vectors in place of the input.
+        Vector<T> values(found);
+        std::copy(w.data(), w.data() + found, values.data());
+        if (!options.vectors)
+            return Eigen<T, L>{std::move(values), Matrix<T, 0, 0, L>(), 0};
+        if (all)
+            return Eigen<T, L>{std::move(values), std::move(_temp), 0};
+
+        return Eigen<T, L>{std::move(values), Matrix<T, 0, 0, L>(Z.view().block(1, 1, n, found)), 0};
+    }
+
+    template<typename T, Layout L>
+    Eigen<T, L> eig_sym(Matrix<T, 0, 0, L> &M, EigenOptions options = {}) {
+        EigenWorkspace<T> workspace;
+        return eig_sym(M, options, workspace);
+    }
+
+};
+
+#endif //MINILA_EIGEN_H
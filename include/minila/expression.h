@@ -0,0 +1,178 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_EXPRESSION_H
+#define MINILA_EXPRESSION_H
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "layout.h"
+
+namespace minila {
+
+    // Lazy elementwise expressions. Operators on BaseArray, Matrix and Vector
+    // build a tree of nodes instead of temporaries; the whole chain is evaluated
+    // in a single loop when assigned to (or used to construct) a container.
+    // Nodes reference the containers they were built from, so do not keep them
+    // (e.g. through `auto`) beyond the lifetime of their operands.
+    // Large arrays are evaluated in parallel, so functions passed to apply must be
+    // safe to call from several threads at once.
+
+    // Tag shared by every expression node.
+    struct Expression {};
+
+    template<typename E>
+    concept IsExpression = std::derived_from<E, Expression>;
+
+    // Anything that can take part in an expression: nodes and containers.
+    template<typename E>
+    concept IsOperand = requires(const E &e) {{ e.expression() } -> IsExpression; };
+
+    // Leaf node over contiguous storage.
+    template<typename T>
+    class ArrayExpression : public Expression {
+
+    public:
+        ArrayExpression(const T *data, const uint64_t *dimensions, uint64_t ndim, uint64_t size,
+                        Layout layout = Layout::RowMajor) :
+                _data(data), _dimensions(dimensions), _ndim(ndim), _size(size), _layout(layout) {}
+
+        T operator[](uint64_t index) const { return _data[index]; }
+
+        const T *data() const { return _data; }
+
+        uint64_t ndim() const { return _ndim; }
+
+        const uint64_t *dimensions() const { return _dimensions; }
+
+        uint64_t size() const { return _size; }
+
+        // Storage order of the elements; operands must agree for [] to line up.
+        Layout layout() const { return _layout; }
+
+        ArrayExpression<T> expression() const { return *this; }
+
+    private:
+        const T *_data;
+        const uint64_t *_dimensions;
+        uint64_t _ndim, _size;
+        Layout _layout;
+    };
+
+    // Applies F to every element of E.
+    template<typename E, typename F>
+    class UnaryExpression : public Expression {
+
+    public:
+        UnaryExpression(const E &operand, F function) : _operand(operand), _function(function) {}
+
+        auto operator[](uint64_t index) const { return _function(_operand[index]); }
+
+        uint64_t ndim() const { return _operand.ndim(); }
+
+        const uint64_t *dimensions() const { return _operand.dimensions(); }
+
+        uint64_t size() const { return _operand.size(); }
+
+        Layout layout() const { return _operand.layout(); }
+
+        UnaryExpression<E, F> expression() const { return *this; }
+
+    private:
+        E _operand;
+        F _function;
+    };
+
+    // Combines L and R elementwise through Op.
+    template<typename L, typename R, typename Op>
+    class BinaryExpression : public Expression {
+
+    public:
+        BinaryExpression(const L &left, const R &right, Op op) : _left(left), _right(right), _op(op) {
+            if (left.ndim() != right.ndim() ||
+                !std::equal(left.dimensions(), left.dimensions() + left.ndim(), right.dimensions()))
+                throw std::invalid_argument("Dimension size mismatch for operation.");
+            if (left.layout() != right.layout())
+                throw std::invalid_argument("Layout mismatch for operation.");
+        }
+
+        auto operator[](uint64_t index) const { return _op(_left[index], _right[index]); }
+
+        const L &left() const { return _left; }
+
+        const R &right() const { return _right; }
+
+        uint64_t ndim() const { return _left.ndim(); }
+
+        const uint64_t *dimensions() const { return _left.dimensions(); }
+
+        uint64_t size() const { return _left.size(); }
+
+        Layout layout() const { return _left.layout(); }
+
+        BinaryExpression<L, R, Op> expression() const { return *this; }
+
+    private:
+        L _left;
+        R _right;
+        Op _op;
+    };
+
+    template<typename L, typename R>
+    requires IsOperand<L> && IsOperand<R>
+    auto operator+(const L &left, const R &right) {
+        auto l = left.expression();
+        auto r = right.expression();
+        return BinaryExpression<decltype(l), decltype(r), std::plus<>>(l, r, std::plus<>());
+    }
+
+    template<typename L, typename R>
+    requires IsOperand<L> && IsOperand<R>
+    auto operator-(const L &left, const R &right) {
+        auto l = left.expression();
+        auto r = right.expression();
+        return BinaryExpression<decltype(l), decltype(r), std::minus<>>(l, r, std::minus<>());
+    }
+
+    // Applies an arbitrary elementwise function, fused with the rest of the chain.
+    template<typename E, typename F>
+    requires IsOperand<E>
+    auto apply(const E &operand, F function) {
+        auto e = operand.expression();
+        return UnaryExpression<decltype(e), F>(e, function);
+    }
+
+    template<typename E>
+    requires IsOperand<E>
+    auto operator-(const E &operand) {
+        return apply(operand, std::negate<>());
+    }
+
+    template<typename E, typename S>
+    requires IsOperand<E> && std::is_arithmetic_v<S>
+    auto operator*(const E &left, S right) {
+        return apply(left, [right](auto element) { return element * right; });
+    }
+
+    template<typename E, typename S>
+    requires IsOperand<E> && std::is_arithmetic_v<S>
+    auto operator*(S left, const E &right) {
+        return apply(right, [left](auto element) { return left * element; });
+    }
+
+    template<typename E, typename S>
+    requires IsOperand<E> && std::is_arithmetic_v<S>
+    auto operator/(const E &left, S right) {
+        return apply(left, [right](auto element) { return element / right; });
+    }
+
+};
+
+#endif //MINILA_EXPRESSION_H
@@ -0,0 +1,397 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_FIXED_H
+#define MINILA_FIXED_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "base.h"
+#include "lu.h"
+#include "matrix.h"
+#include "vector.h"
+#include "view.h"
+
+namespace minila {
+
+    // Compile-time sized matrices and vectors for small problems (2x2 up to ~8x8).
+    // Elements live inline, with no heap allocation, and every operation below is
+    // unrolled at compile time and usable in constant expressions. Use view() and the
+    // MatrixView/VectorView constructors to move data to and from Matrix<T>/Vector<T>.
+
+    // Calls f(0), f(1), ..., f(N - 1), unrolled.
+    template<uint64_t N, typename F>
+    constexpr void _unroll(F &&f) {
+        [&]<uint64_t... Is>(std::integer_sequence<uint64_t, Is...>) {
+            (f(Is), ...);
+        }(std::make_integer_sequence<uint64_t, N>());
+    }
+
+    template<typename T, uint64_t R, uint64_t C, Layout L>
+    class Matrix {
+        static_assert(R > 0 && C > 0, "Fixed-size matrices need both dimensions > 0.");
+        static_assert(L == Layout::RowMajor, "Fixed-size matrices are row-major.");
+
+    public:
+        constexpr Matrix() : _data{} {}
+
+        // Row-major values
+        constexpr explicit Matrix(const std::array<T, R * C> &values) : _data(values) {}
+
+        // Copies a R x C view, e.g. from a Matrix<T>
+        explicit Matrix(MatrixView<T> right);
+
+        constexpr T &operator()(uint64_t row, uint64_t col);
+
+        constexpr const T &operator()(uint64_t row, uint64_t col) const;
+
+        static constexpr uint64_t rows() { return R; }
+
+        static constexpr uint64_t cols() { return C; }
+
+        static constexpr Layout layout() { return L; }
+
+        constexpr T *data() { return _data.data(); }
+
+        constexpr const T *data() const { return _data.data(); }
+
+        MatrixView<T> view() { return MatrixView<T>(_data.data(), R, C, C, 1); }
+
+    private:
+        std::array<T, R * C> _data;
+    };
+
+    template<typename T, uint64_t N>
+    class Vector {
+        static_assert(N > 0, "Fixed-size vectors need dimension > 0.");
+
+    public:
+        constexpr Vector() : _data{} {}
+
+        constexpr explicit Vector(const std::array<T, N> &values) : _data(values) {}
+
+        // Copies a view of N elements, e.g. from a Vector<T>
+        explicit Vector(VectorView<T> right);
+
+        constexpr T &operator()(uint64_t dimension);
+
+        constexpr const T &operator()(uint64_t dimension) const;
+
+        static constexpr uint64_t dimensions() { return N; }
+
+        constexpr T *data() { return _data.data(); }
+
+        constexpr const T *data() const { return _data.data(); }
+
+        VectorView<T> view() { return VectorView<T>(_data.data(), N, 1); }
+
+    private:
+        std::array<T, N> _data;
+    };
+
+    template<typename T, uint64_t R, uint64_t C, Layout L>
+    Matrix<T, R, C, L>::Matrix(MatrixView<T> right) : _data{} {
+        if (right.rows() != R || right.cols() != C)
+            throw std::invalid_argument("Dimension size mismatch for operation.");
+
+        for (uint64_t i = 1; i <= R; i++)
+            for (uint64_t j = 1; j <= C; j++)
+                (*this)(i, j) = right(i, j);
+    }
+
+    template<typename T, uint64_t R, uint64_t C, Layout L>
+    constexpr T &Matrix<T, R, C, L>::operator()(uint64_t row, uint64_t col) {
+#ifdef MINILA_BOUNDS_CHECK
+        if (row == 0 || row > R || col == 0 || col > C)
+            throw std::invalid_argument("Axis size mismatch for operation.");
+#endif
+
+        return _data[(row - 1) * C + (col - 1)];
+    }
+
+    template<typename T, uint64_t R, uint64_t C, Layout L>
+    constexpr const T &Matrix<T, R, C, L>::operator()(uint64_t row, uint64_t col) const {
+#ifdef MINILA_BOUNDS_CHECK
+        if (row == 0 || row > R || col == 0 || col > C)
+            throw std::invalid_argument("Axis size mismatch for operation.");
+#endif
+
+        return _data[(row - 1) * C + (col - 1)];
+    }
+
+    template<typename T, uint64_t N>
+    Vector<T, N>::Vector(VectorView<T> right) : _data{} {
+        if (right.dimensions() != N)
+            throw std::invalid_argument("Dimension size mismatch for operation.");
+
+        for (uint64_t i = 1; i <= N; i++)
+            (*this)(i) = right(i);
+    }
+
+    template<typename T, uint64_t N>
+    constexpr T &Vector<T, N>::operator()(uint64_t dimension) {
+#ifdef MINILA_BOUNDS_CHECK
+        if (dimension == 0 || dimension > N)
+            throw std::invalid_argument("Axis size mismatch for operation.");
+#endif
+
+        return _data[dimension - 1];
+    }
+
+    template<typename T, uint64_t N>
+    constexpr const T &Vector<T, N>::operator()(uint64_t dimension) const {
+#ifdef MINILA_BOUNDS_CHECK
+        if (dimension == 0 || dimension > N)
+            throw std::invalid_argument("Axis size mismatch for operation.");
+#endif
+
+        return _data[dimension - 1];
+    }
+
+    // Matrix + Matrix
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Matrix<T, R, C> operator+(const Matrix<T, R, C> &left, const Matrix<T, R, C> &right) {
+        Matrix<T, R, C> result;
+        _unroll<R * C>([&](uint64_t i) { result.data()[i] = left.data()[i] + right.data()[i]; });
+
+        return result;
+    }
+
+    // Matrix - Matrix
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Matrix<T, R, C> operator-(const Matrix<T, R, C> &left, const Matrix<T, R, C> &right) {
+        Matrix<T, R, C> result;
+        _unroll<R * C>([&](uint64_t i) { result.data()[i] = left.data()[i] - right.data()[i]; });
+
+        return result;
+    }
+
+    // Matrix * scalar
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Matrix<T, R, C> operator*(const Matrix<T, R, C> &left, T right) {
+        Matrix<T, R, C> result;
+        _unroll<R * C>([&](uint64_t i) { result.data()[i] = left.data()[i] * right; });
+
+        return result;
+    }
+
+    // scalar * Matrix
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Matrix<T, R, C> operator*(T left, const Matrix<T, R, C> &right) {
+        return right * left;
+    }
+
+    // Vector + Vector
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr Vector<T, N> operator+(const Vector<T, N> &left, const Vector<T, N> &right) {
+        Vector<T, N> result;
+        _unroll<N>([&](uint64_t i) { result.data()[i] = left.data()[i] + right.data()[i]; });
+
+        return result;
+    }
+
+    // Vector - Vector
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr Vector<T, N> operator-(const Vector<T, N> &left, const Vector<T, N> &right) {
+        Vector<T, N> result;
+        _unroll<N>([&](uint64_t i) { result.data()[i] = left.data()[i] - right.data()[i]; });
+
+        return result;
+    }
+
+    // Vector * scalar
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr Vector<T, N> operator*(const Vector<T, N> &left, T right) {
+        Vector<T, N> result;
+        _unroll<N>([&](uint64_t i) { result.data()[i] = left.data()[i] * right; });
+
+        return result;
+    }
+
+    // scalar * Vector
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr Vector<T, N> operator*(T left, const Vector<T, N> &right) {
+        return right * left;
+    }
+
+    // Vector * Vector
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr T dot(const Vector<T, N> &left, const Vector<T, N> &right) {
+        T result = 0;
+        _unroll<N>([&](uint64_t i) { result += left.data()[i] * right.data()[i]; });
+
+        return result;
+    }
+
+    // Matrix * Vector
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Vector<T, R> multiply(const Matrix<T, R, C> &M, const Vector<T, C> &v) {
+        Vector<T, R> result;
+        _unroll<R>([&](uint64_t i) {
+            T sum = 0;
+            _unroll<C>([&](uint64_t k) { sum += M.data()[i * C + k] * v.data()[k]; });
+            result.data()[i] = sum;
+        });
+
+        return result;
+    }
+
+    // Vector * Matrix
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Vector<T, C> multiply(const Vector<T, R> &v, const Matrix<T, R, C> &M) {
+        Vector<T, C> result;
+        _unroll<C>([&](uint64_t j) {
+            T sum = 0;
+            _unroll<R>([&](uint64_t k) { sum += v.data()[k] * M.data()[k * C + j]; });
+            result.data()[j] = sum;
+        });
+
+        return result;
+    }
+
+    // Matrix * Matrix
+    template<typename T, uint64_t R, uint64_t K, uint64_t C>
+    requires (R > 0 && K > 0 && C > 0)
+    constexpr Matrix<T, R, C> multiply(const Matrix<T, R, K> &left, const Matrix<T, K, C> &right) {
+        Matrix<T, R, C> result;
+        _unroll<R>([&](uint64_t i) {
+            _unroll<C>([&](uint64_t j) {
+                T sum = 0;
+                _unroll<K>([&](uint64_t k) { sum += left.data()[i * K + k] * right.data()[k * C + j]; });
+                result.data()[i * C + j] = sum;
+            });
+        });
+
+        return result;
+    }
+
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Vector<T, R> operator*(const Matrix<T, R, C> &left, const Vector<T, C> &right) {
+        return multiply(left, right);
+    }
+
+    template<typename T, uint64_t R, uint64_t C>
+    requires (R > 0 && C > 0)
+    constexpr Vector<T, C> operator*(const Vector<T, R> &left, const Matrix<T, R, C> &right) {
+        return multiply(left, right);
+    }
+
+    template<typename T, uint64_t R, uint64_t K, uint64_t C>
+    requires (R > 0 && K > 0 && C > 0)
+    constexpr Matrix<T, R, C> operator*(const Matrix<T, R, K> &left, const Matrix<T, K, C> &right) {
+        return multiply(left, right);
+    }
+
+    // LU with partial pivoting, laid out like ?getrf: D holds the unit lower L and
+    // U, ipiv(i) is the (1-based) row swapped with row i and info > 0 flags an
+    // exactly singular U(info, info).
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr LU<T, N> lu(const Matrix<T, N, N> &M) {
+        LU<T, N> result{M, Vector<int, N>(), 0};
+        T *D = result.D.data();
+
+        _unroll<N>([&](uint64_t k) {
+            uint64_t pivot = k;
+            _unroll<N>([&](uint64_t i) {
+                auto candidate = D[i * N + k] < 0 ? -D[i * N + k] : D[i * N + k];
+                auto current = D[pivot * N + k] < 0 ? -D[pivot * N + k] : D[pivot * N + k];
+                if (i > k && candidate > current)
+                    pivot = i;
+            });
+            result.ipiv.data()[k] = int(pivot + 1);
+
+            if (pivot != k)
+                _unroll<N>([&](uint64_t j) { std::swap(D[k * N + j], D[pivot * N + j]); });
+
+            if (D[k * N + k] == T(0)) {
+                if (result.info == 0)
+                    result.info = int(k + 1);
+                return;
+            }
+
+            _unroll<N>([&](uint64_t i) {
+                if (i > k) {
+                    D[i * N + k] /= D[k * N + k];
+                    _unroll<N>([&](uint64_t j) {
+                        if (j > k)
+                            D[i * N + j] -= D[i * N + k] * D[k * N + j];
+                    });
+                }
+            });
+        });
+
+        return result;
+    }
+
+    // Solves A x = b from the factors of A.
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr Vector<T, N> solve(const LU<T, N> &factors, const Vector<T, N> &b) {
+        if (factors.info != 0)
+            throw std::runtime_error("Singular matrix in solve.");
+
+        Vector<T, N> x(b);
+        T *y = x.data();
+        const T *D = factors.D.data();
+
+        _unroll<N>([&](uint64_t k) { std::swap(y[k], y[factors.ipiv.data()[k] - 1]); });
+        _unroll<N>([&](uint64_t i) {
+            _unroll<N>([&](uint64_t j) { if (j < i) y[i] -= D[i * N + j] * y[j]; });
+        });
+        _unroll<N>([&](uint64_t r) {
+            const uint64_t i = N - 1 - r;
+            _unroll<N>([&](uint64_t j) { if (j > i) y[i] -= D[i * N + j] * y[j]; });
+            y[i] /= D[i * N + i];
+        });
+
+        return x;
+    }
+
+    // Solves A x = b
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr Vector<T, N> solve(const Matrix<T, N, N> &A, const Vector<T, N> &b) {
+        return solve(lu(A), b);
+    }
+
+    // Determinant from the factors of A.
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr T det(const LU<T, N> &factors) {
+        T result = 1;
+        _unroll<N>([&](uint64_t i) {
+            result *= factors.D.data()[i * N + i];
+            if (factors.ipiv.data()[i] != int(i + 1))
+                result = -result;
+        });
+
+        return result;
+    }
+
+    template<typename T, uint64_t N>
+    requires (N > 0)
+    constexpr T det(const Matrix<T, N, N> &A) {
+        return det(lu(A));
+    }
+
+};
+
+#endif //MINILA_FIXED_H
@@ -0,0 +1,86 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_HALF_H
+#define MINILA_HALF_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+namespace minila {
+
+    // 16-bit floating point storage types. They only hold bits: arithmetic widens
+    // to float through the implicit conversion, so a Matrix<bf16> halves memory
+    // traffic while products still accumulate in float (see blocked::gemm and the
+    // naive Matrix * Vector). Narrowing from float is explicit and rounds to nearest even.
+
+    // bfloat16: the upper half of a float (8-bit exponent, 7-bit mantissa).
+    struct bf16 {
+        uint16_t bits = 0;
+
+        bf16() = default;
+
+        explicit bf16(float value) : bits(_narrow(value)) {}
+
+        operator float() const { return std::bit_cast<float>(uint32_t(bits) << 16); }
+
+        static uint16_t _narrow(float value) {
+            const uint32_t w = std::bit_cast<uint32_t>(value);
+            if ((w & 0x7FFFFFFFu) > 0x7F800000u)
+                return uint16_t((w >> 16) | 0x0040u); // Keeps NaNs quiet, never rounds them to infinity.
+
+            return uint16_t((w + 0x7FFFu + ((w >> 16) & 1u)) >> 16);
+        }
+    };
+
+    // IEEE 754 binary16 (5-bit exponent, 10-bit mantissa), with subnormals.
+    struct fp16 {
+        uint16_t bits = 0;
+
+        fp16() = default;
+
+        explicit fp16(float value) : bits(_narrow(value)) {}
+
+        operator float() const {
+            const uint32_t w = uint32_t(bits) << 16, sign = w & 0x80000000u, two_w = w + w;
+
+            // Normal values rebias the exponent through a multiply, which also turns
+            // the maximum exponent into infinity/NaN; subnormals are built as 0.5 + m
+            // scaled into a float and have the 0.5 subtracted back.
+            const float normal = std::bit_cast<float>((two_w >> 4) + (0xE0u << 23)) * 0x1.0p-112f;
+            const float subnormal = std::bit_cast<float>((two_w >> 17) | (126u << 23)) - 0.5f;
+
+            return std::bit_cast<float>(sign | std::bit_cast<uint32_t>(two_w < (1u << 27) ? subnormal : normal));
+        }
+
+        static uint16_t _narrow(float value) {
+            const uint32_t w = std::bit_cast<uint32_t>(value), shl1_w = w + w, sign = w & 0x80000000u;
+
+            // Scaling up then down flushes overflow to infinity; adding a power of two
+            // matched to the exponent lets the float adder do the rounding to 10 bits.
+            float base = (std::bit_cast<float>(w & 0x7FFFFFFFu) * 0x1.0p+112f) * 0x1.0p-110f;
+            const uint32_t bias = std::max(shl1_w & 0xFF000000u, 0x71000000u);
+            base = std::bit_cast<float>((bias >> 1) + 0x07800000u) + base;
+
+            const uint32_t bits = std::bit_cast<uint32_t>(base);
+            const uint32_t nonsign = ((bits >> 13) & 0x7C00u) + (bits & 0x0FFFu);
+
+            return uint16_t((sign >> 16) | (shl1_w > 0xFF000000u ? 0x7E00u : nonsign));
+        }
+    };
+
+    template<typename T>
+    concept IsHalf = std::is_same_v<T, bf16> || std::is_same_v<T, fp16>;
+
+    // Types BaseArray can store: the arithmetic types and the 16-bit floats.
+    template<typename T>
+    concept IsElement = std::is_arithmetic_v<T> || IsHalf<T>;
+
+};
+
+#endif //MINILA_HALF_H
@@ -9,59 +9,97 @@
 
 #include <functional>
 #include "constants.h"
+#include "thread_pool.h"
 
 namespace minila::integration {
 
+    // Subdivisions per parallel task. Each one costs a few calls to the integrand,
+    // so the grain is smaller than for plain elementwise work.
+    constexpr uint64_t MINILA_INTEGRATION_GRAIN = ThreadPool::grain(32);
+
+    // Sums partial(first, last) over [0, subdivisions): in one serial pass, or
+    // over the thread pool when parallel. Parallel calls the integrand from
+    // several threads at once, so it is opt-in and only for integrands that are
+    // safe to call that way (no shared RNG, counter or cache).
+    template<typename T, typename F>
+    T _sum(uint64_t subdivisions, bool parallel, F &&partial) {
+        if (!parallel)
+            return partial(uint64_t(0), subdivisions);
+
+        return ThreadPool::global().parallel_reduce(subdivisions, MINILA_INTEGRATION_GRAIN, T(0), partial);
+    }
+
     template<class F, typename T>
     requires std::floating_point<T>
-    auto trapezium(F &function, T start, T end, uint32_t subdivisions = MINILA_TRAPEZIUM) {
+    auto trapezium(F &function, T start, T end, uint32_t subdivisions = MINILA_TRAPEZIUM,
+                   bool parallel = false) {
         // Checks during compile time if function being used is suitable;
         // Accepts functions of one argument of same type as starting point.
         std::function<T(T)> f(function);
 
         auto h = (end - start) / subdivisions;
-        T result = 0;
-        for (uint32_t i = 0; i < subdivisions; i++) {
-            auto a = start + h * i;
-            auto b = start + h * (i + 1);
-            result += (f(a) + f(b)) / 2;
-        }
+        auto partial = [&](uint64_t first, uint64_t last) {
+            T result = 0;
+            for (uint64_t i = first; i < last; i++) {
+                auto a = start + h * i;
+                auto b = start + h * (i + 1);
+                result += (f(a) + f(b)) / 2;
+            }
+
+            return result;
+        };
+
+        T result = _sum<T>(subdivisions, parallel, partial);
 
         return h * result;
     }
 
     template<class F, typename T>
     requires std::floating_point<T>
-    auto simpson(F &function, T start, T end, uint32_t subdivisions = MINILA_SIMPSON) {
+    auto simpson(F &function, T start, T end, uint32_t subdivisions = MINILA_SIMPSON,
+                 bool parallel = false) {
         // Checks during compile time if function being used is suitable;
         // Accepts functions of one argument of same type as starting point.
         std::function<T(T)> f(function);
 
         auto h = (end - start) / subdivisions;
-        T result = 0;
-        for (uint32_t i = 0; i < subdivisions; i++) {
-            auto a = start + h * i;
-            auto b = start + h * (i + 1);
-            result += f(a) + 4 * f((a + b) / 2) + f(b);
-        }
+        auto partial = [&](uint64_t first, uint64_t last) {
+            T result = 0;
+            for (uint64_t i = first; i < last; i++) {
+                auto a = start + h * i;
+                auto b = start + h * (i + 1);
+                result += f(a) + 4 * f((a + b) / 2) + f(b);
+            }
+
+            return result;
+        };
+
+        T result = _sum<T>(subdivisions, parallel, partial);
 
         return (h / 6) * result;
     }
 
     template<class F, typename T>
     requires std::floating_point<T>
-    auto simpson38(F &function, T start, T end, uint32_t subdivisions = MINILA_SIMPSON_38) {
+    auto simpson38(F &function, T start, T end, uint32_t subdivisions = MINILA_SIMPSON_38,
+                   bool parallel = false) {
         // Checks during compile time if function being used is suitable;
         // Accepts functions of one argument of same type as starting point.
         std::function<T(T)> f(function);
 
         auto h = (end - start) / subdivisions;
-        T result = 0;
-        for (uint32_t i = 0; i < subdivisions; i++) {
-            auto a = start + h * i;
-            auto b = start + h * (i + 1);
-            result += f(a) + 3 * f((2 * a + b) / 3) + 3 * f((a + 2 * b) / 3) + f(b);
-        }
+        auto partial = [&](uint64_t first, uint64_t last) {
+            T result = 0;
+            for (uint64_t i = first; i < last; i++) {
+                auto a = start + h * i;
+                auto b = start + h * (i + 1);
+                result += f(a) + 3 * f((2 * a + b) / 3) + 3 * f((a + 2 * b) / 3) + f(b);
+            }
+
+            return result;
+        };
+
+        T result = _sum<T>(subdivisions, parallel, partial);
 
         return (h / 8) * result;
     }
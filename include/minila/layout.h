@@ -0,0 +1,26 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_LAYOUT_H
+#define MINILA_LAYOUT_H
+
+#include <cstdint>
+
+namespace minila {
+
+    // Storage order of a matrix. RowMajor keeps the elements of a row contiguous
+    // (the BaseArray order), ColMajor keeps the elements of a column contiguous
+    // (the Fortran/LAPACK order).
+    enum class Layout {
+        RowMajor,
+        ColMajor
+    };
+
+    constexpr uint64_t MINILA_LAYOUT_BLOCK = 32; // Tile size, in elements, for layout conversions.
+
+};
+
+#endif //MINILA_LAYOUT_H
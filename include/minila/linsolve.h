@@ -7,13 +7,19 @@
 #ifndef MINILA_LINSOLVE_H
 #define MINILA_LINSOLVE_H
 
+#include <algorithm>
 #include <lapacke.h>
 #include <stdexcept>
+#include <type_traits>
+#include "layout.h"
+#include "lu.h"
 #include "matrix.h"
 #include "vector.h"
 
 namespace minila {
-    // Simple functions to solve linear systems of square matrices.
+    // Simple functions to solve linear systems of square matrices: one ?getrf
+    // and one ?getrs. To solve against the same left-hand side repeatedly, keep
+    // lu(left) and call its solve() instead.
 
     template<typename T>
     Matrix<T> linsolve(Matrix<T> &left, Matrix<T> &right) {
@@ -22,12 +28,83 @@ namespace minila {
 
     template<>
     Matrix<float> linsolve(Matrix<float> &left, Matrix<float> &right) {
-
+        return lu(left).solve(right);
     }
 
     template<>
     Matrix<double> linsolve(Matrix<double> &left, Matrix<double> &right) {
+        return lu(left).solve(right);
+    }
+
+    template<typename T>
+    Vector<T> linsolve(Matrix<T> &left, Vector<T> &right) {
+        throw std::runtime_error("Unsupported type for linsolve.");
+    }
+
+    template<>
+    Vector<float> linsolve(Matrix<float> &left, Vector<float> &right) {
+        return lu(left).solve(right);
+    }
+
+    template<>
+    Vector<double> linsolve(Matrix<double> &left, Vector<double> &right) {
+        return lu(left).solve(right);
+    }
+
+    // Least squares min ||A X - B|| (the minimum norm solution when A is wide):
+    // ?gels through QR or LQ for full-rank A, or ?gelsd through a divide and
+    // conquer SVD, which also handles rank-deficient A. Singular values below
+    // rcond times the largest count as zero (rcond < 0: machine precision).
+    enum class LstsqDriver {
+        QR,
+        SVD
+    };
+
+    template<typename T, Layout L1, Layout L2>
+    Matrix<T, 0, 0, L2> lstsq(Matrix<T, 0, 0, L1> &A, Matrix<T, 0, 0, L2> &B,
+                              LstsqDriver driver = LstsqDriver::QR, double rcond = -1) {
+        const uint64_t m = A.rows(), n = A.cols(), nrhs = B.cols();
+        if (m != B.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation lstsq.");
+
+        // Both are overwritten; X holds B on the way in and the solution on the way out.
+        auto _temp = Matrix<T, 0, 0, L1>(A);
+        auto X = Matrix<T, 0, 0, L1>(std::max(m, n), nrhs);
+        copy(B.view(), X.view().block(1, 1, m, nrhs));
+
+        auto layout = L1 == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+        Vector<T> s(std::max<uint64_t>(1, std::min(m, n)));
+        int rank, info;
+        if constexpr (std::is_same_v<T, float>)
+            info = driver == LstsqDriver::QR
+                   ? LAPACKE_sgels(layout, 'N', m, n, nrhs, _temp.data(), _temp.leading_dimension(), X.data(),
+                                   X.leading_dimension())
+                   : LAPACKE_sgelsd(layout, m, n, nrhs, _temp.data(), _temp.leading_dimension(), X.data(),
+                                    X.leading_dimension(), s.data(), float(rcond), &rank);
+        else if constexpr (std::is_same_v<T, double>)
+            info = driver == LstsqDriver::QR
+                   ? LAPACKE_dgels(layout, 'N', m, n, nrhs, _temp.data(), _temp.leading_dimension(), X.data(),
+                                   X.leading_dimension())
+                   : LAPACKE_dgelsd(layout, m, n, nrhs, _temp.data(), _temp.leading_dimension(), X.data(),
+                                    X.leading_dimension(), s.data(), rcond, &rank);
+        else
+            throw std::runtime_error("Unsupported type for lstsq.");
+
+        if (info > 0)
+            throw std::runtime_error(driver == LstsqDriver::QR ? "Rank deficient matrix in lstsq."
+                                                               : "SVD did not converge in lstsq.");
+        if (info != 0)
+            throw std::runtime_error("LAPACK error in lstsq.");
+
+        return Matrix<T, 0, 0, L2>(X.view().block(1, 1, n, nrhs));
+    }
+
+    template<typename T, Layout L>
+    Vector<T> lstsq(Matrix<T, 0, 0, L> &A, Vector<T> &b, LstsqDriver driver = LstsqDriver::QR, double rcond = -1) {
+        auto B = Matrix<T, 0, 0, L>(MatrixView<T>(b.data(), b.dimensions(), 1, 1, 1));
+        auto X = lstsq(A, B, driver, rcond);
 
+        return Vector<T>(VectorView<T>(X.data(), X.rows(), 1));
     }
 
 };
@@ -7,46 +7,153 @@
 #ifndef MINILA_LU_H
 #define MINILA_LU_H
 
+#include <algorithm>
 #include <lapacke.h>
 #include <stdexcept>
+#include <type_traits>
 #include "constants.h"
+#include "layout.h"
 #include "matrix.h"
+#include "vector.h"
 
 namespace minila {
 
-    template<typename T>
+    // N > 0 holds the factors of a fixed-size Matrix<T, N, N> (see fixed.h).
+    template<typename T, uint64_t N = 0, Layout L = Layout::RowMajor>
     struct LU {
-        Matrix<T> D; // Store the decomposition
-        Vector<int> ipiv; // Stores the pivoting vector
+        Matrix<T, N, N, L> D; // Store the decomposition
+        Vector<int, N> ipiv; // Stores the pivoting vector
 
         int info = 0; // Stores the info result for calculation
-    };
 
-    template<typename T>
-    LU<T> lu(Matrix<T> &M) {
-        throw std::runtime_error("Unsupported type for LU.");
-    }
+        // Solves A x = b through ?getrs, reusing the factors: O(n^2) per
+        // right-hand side instead of refactoring A in O(n^3).
+        Vector<T> solve(Vector<T> &b) requires (N == 0);
+
+        // Solves A X = B for all columns of B at once; X has the layout of B.
+        template<Layout LB>
+        Matrix<T, 0, 0, LB> solve(Matrix<T, 0, 0, LB> &B) requires (N == 0);
+
+        // Product of U's diagonal, with the sign of the row permutation.
+        T det() requires (N == 0);
+
+        // A^-1 through ?getri. Prefer solve() when the inverse is only applied.
+        Matrix<T, 0, 0, L> inverse() requires (N == 0);
 
-    template<>
-    LU<float> lu(Matrix<float> &M) {
+    private:
+        void _square();
+
+        void _solve(uint64_t nrhs, T *B, uint64_t ldb);
+    };
+
+    // Column-major matrices are factored in place by LAPACK. Row-major ones go
+    // through the LAPACKE row-major interface, which transposes internally.
+    template<typename T, Layout L>
+    LU<T, 0, L> lu(Matrix<T, 0, 0, L> &M) {
         auto D = Matrix(M);
         auto ipiv = Vector<int>(std::max((uint64_t) 1,
                                          (uint64_t) std::min(M.rows(), M.cols())));
 
-        auto info = LAPACKE_sgetrf(LAPACK_COL_MAJOR, D.rows(), D.cols(), D.data(), D.rows(), ipiv.data());
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int info;
+        if constexpr (std::is_same_v<T, float>)
+            info = LAPACKE_sgetrf(layout, D.rows(), D.cols(), D.data(), D.leading_dimension(), ipiv.data());
+        else if constexpr (std::is_same_v<T, double>)
+            info = LAPACKE_dgetrf(layout, D.rows(), D.cols(), D.data(), D.leading_dimension(), ipiv.data());
+        else
+            throw std::runtime_error("Unsupported type for LU.");
 
-        return LU<float>{D, ipiv, info};
+        return LU<T, 0, L>{std::move(D), std::move(ipiv), info};
     }
 
-    template<>
-    LU<double> lu(Matrix<double> &M) {
-        auto D = Matrix(M);
-        auto ipiv = Vector<int>(std::max((uint64_t) 1,
-                                         (uint64_t) std::min(M.rows(), M.cols())));
+    template<typename T, uint64_t N, Layout L>
+    void LU<T, N, L>::_square() {
+        if (D.rows() != D.cols())
+            throw std::invalid_argument("LU of a non-square matrix cannot solve, det or inverse.");
+    }
+
+    // B <- A^-1 B for nrhs right-hand sides stored in the layout of D.
+    template<typename T, uint64_t N, Layout L>
+    void LU<T, N, L>::_solve(uint64_t nrhs, T *B, uint64_t ldb) {
+        _square();
+        if (info != 0)
+            throw std::runtime_error("Singular matrix in LU::solve.");
+
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int result;
+        if constexpr (std::is_same_v<T, float>)
+            result = LAPACKE_sgetrs(layout, 'N', D.rows(), nrhs, D.data(), D.leading_dimension(), ipiv.data(), B,
+                                    ldb);
+        else if constexpr (std::is_same_v<T, double>)
+            result = LAPACKE_dgetrs(layout, 'N', D.rows(), nrhs, D.data(), D.leading_dimension(), ipiv.data(), B,
+                                    ldb);
+        else
+            throw std::runtime_error("Unsupported type for LU.");
+
+        if (result != 0)
+            throw std::runtime_error("LAPACK error in LU::solve.");
+    }
+
+    template<typename T, uint64_t N, Layout L>
+    Vector<T> LU<T, N, L>::solve(Vector<T> &b) requires (N == 0) {
+        if (D.rows() != b.dimensions())
+            throw std::invalid_argument("Invalid axis sizes on operation LU::solve.");
+
+        auto x = Vector<T>(b);
+        _solve(1, x.data(), L == Layout::ColMajor ? std::max<uint64_t>(1, x.dimensions()) : 1);
+
+        return x;
+    }
+
+    template<typename T, uint64_t N, Layout L>
+    template<Layout LB>
+    Matrix<T, 0, 0, LB> LU<T, N, L>::solve(Matrix<T, 0, 0, LB> &B) requires (N == 0) {
+        if (D.rows() != B.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation LU::solve.");
+
+        auto X = to_layout<L>(B);
+        _solve(X.cols(), X.data(), X.leading_dimension());
+
+        return to_layout<LB>(X);
+    }
+
+    template<typename T, uint64_t N, Layout L>
+    T LU<T, N, L>::det() requires (N == 0) {
+        _square();
+
+        T result = 1;
+        for (uint64_t i = 1; i <= D.rows(); i++) {
+            result *= D.at_unchecked(i, i);
+            if (ipiv.data()[i - 1] != int(i))
+                result = -result;
+        }
+
+        return result;
+    }
+
+    template<typename T, uint64_t N, Layout L>
+    Matrix<T, 0, 0, L> LU<T, N, L>::inverse() requires (N == 0) {
+        _square();
+        if (info != 0)
+            throw std::runtime_error("Singular matrix in LU::inverse.");
+
+        auto result = Matrix<T, 0, 0, L>(D);
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int status;
+        if constexpr (std::is_same_v<T, float>)
+            status = LAPACKE_sgetri(layout, result.rows(), result.data(), result.leading_dimension(), ipiv.data());
+        else if constexpr (std::is_same_v<T, double>)
+            status = LAPACKE_dgetri(layout, result.rows(), result.data(), result.leading_dimension(), ipiv.data());
+        else
+            throw std::runtime_error("Unsupported type for LU.");
 
-        auto info = LAPACKE_dgetrf(LAPACK_COL_MAJOR, D.rows(), D.cols(), D.data(), D.rows(), ipiv.data());
+        if (status != 0)
+            throw std::runtime_error("LAPACK error in LU::inverse.");
 
-        return LU<double>{D, ipiv, info};
+        return result;
     }
 
 };
@@ -7,34 +7,85 @@
 #ifndef MINILA_MATRIX_H
 #define MINILA_MATRIX_H
 
+#include <algorithm>
+#include <utility>
 #include "base.h"
+#include "layout.h"
+#include "view.h"
 
 namespace minila {
 
-    template<typename T>
-    class Matrix {
+    // Matrix<T> is heap backed and sized at runtime. Matrix<T, R, C> has its shape
+    // fixed at compile time and stores its elements inline (see fixed.h). L is the
+    // storage order; it is forwarded to BLAS/LAPACK so no call transposes behind
+    // the scenes (see to_layout for explicit conversions).
+    template<typename T, uint64_t R = 0, uint64_t C = 0, Layout L = Layout::RowMajor>
+    class Matrix;
+
+    template<typename T, Layout L>
+    class Matrix<T, 0, 0, L> {
 
     public:
         friend class Matrix;
 
         Matrix() : _data(BaseArray<T>()), _rows(0), _cols(0) {}
 
-        Matrix(const Matrix<T> &right);
+        Matrix(const Matrix &right);
+
+        Matrix(Matrix &&right) noexcept;
 
+        // Takes a rows x cols BaseArray; its buffer is read in this matrix's layout.
         explicit Matrix(BaseArray<T> &right);
 
+        explicit Matrix(BaseArray<T> &&right);
+
+        // Materializes a view into a new, contiguous matrix.
+        explicit Matrix(MatrixView<T> right);
+
         Matrix(uint64_t rows, uint64_t cols);
 
+        Matrix &operator=(const Matrix &right);
+
+        Matrix &operator=(Matrix &&right) noexcept;
+
+        // 1-based element access; bounds checked under MINILA_BOUNDS_CHECK.
         T &operator()(uint64_t row, uint64_t col);
 
-        Matrix<T> operator+(const Matrix<T> &right);
+        // 1-based element access without any checks.
+        T &at_unchecked(uint64_t row, uint64_t col);
+
+        // Evaluates an elementwise expression (e.g. A + B - 2 * C) in a single pass.
+        template<typename E>
+        requires IsExpression<E>
+        Matrix(const E &expression);
+
+        template<typename E>
+        requires IsExpression<E>
+        Matrix &operator=(const E &expression);
 
-        Matrix<T> operator-(const Matrix<T> &right);
+        // Leaf node for elementwise expressions (see expression.h).
+        ArrayExpression<T> expression() const;
+
+        // Zero-copy views over this matrix; valid while the matrix is alive.
+        MatrixView<T> view();
+
+        VectorView<T> row(uint64_t row);
+
+        VectorView<T> col(uint64_t col);
+
+        MatrixView<T> block(uint64_t row, uint64_t col, uint64_t rows, uint64_t cols);
+
+        MatrixView<T> transpose();
 
         uint64_t rows();
 
         uint64_t cols();
 
+        static constexpr Layout layout() { return L; }
+
+        // Distance, in elements, between consecutive rows (RowMajor) or columns (ColMajor).
+        uint64_t leading_dimension();
+
         T *data();
 
     private:
@@ -43,57 +94,214 @@ namespace minila {
 
     };
 
-    template<typename T>
-    Matrix<T>::Matrix(const Matrix<T> &right) {
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L>::Matrix(const Matrix &right) : _data(right._data), _rows(right._rows), _cols(right._cols) {}
+
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L>::Matrix(Matrix &&right) noexcept :
+            _data(std::move(right._data)), _rows(std::exchange(right._rows, 0)), _cols(std::exchange(right._cols, 0)) {}
+
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L>::Matrix(uint64_t rows, uint64_t cols) : _data({rows, cols}), _rows(rows), _cols(cols) {}
+
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L> &Matrix<T, 0, 0, L>::operator=(const Matrix &right) {
+        _data = right._data;
         _rows = right._rows;
         _cols = right._cols;
-        _data = right._data;
+
+        return *this;
     }
 
-    template<typename T>
-    Matrix<T>::Matrix(uint64_t rows, uint64_t cols) {
-        _rows = rows;
-        _cols = cols;
-        _data = BaseArray<T>({rows, cols});
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L> &Matrix<T, 0, 0, L>::operator=(Matrix &&right) noexcept {
+        _data = std::move(right._data);
+        _rows = std::exchange(right._rows, 0);
+        _cols = std::exchange(right._cols, 0);
+
+        return *this;
     }
 
-    template<typename T>
-    T &Matrix<T>::operator()(uint64_t row, uint64_t col) {
-        return _data({row - 1, col - 1});
+    template<typename T, Layout L>
+    T &Matrix<T, 0, 0, L>::operator()(uint64_t row, uint64_t col) {
+#ifdef MINILA_BOUNDS_CHECK
+        if (row == 0 || row > _rows || col == 0 || col > _cols)
+            throw std::invalid_argument("Axis size mismatch for operation.");
+#endif
+
+        return at_unchecked(row, col);
     }
 
-    template<typename T>
-    uint64_t Matrix<T>::rows() {
+    template<typename T, Layout L>
+    inline T &Matrix<T, 0, 0, L>::at_unchecked(uint64_t row, uint64_t col) {
+        if constexpr (L == Layout::RowMajor)
+            return _data.data()[(row - 1) * _cols + (col - 1)];
+        else
+            return _data.data()[(col - 1) * _rows + (row - 1)];
+    }
+
+    template<typename T, Layout L>
+    uint64_t Matrix<T, 0, 0, L>::rows() {
         return _rows;
     }
 
-    template<typename T>
-    uint64_t Matrix<T>::cols() {
+    template<typename T, Layout L>
+    uint64_t Matrix<T, 0, 0, L>::cols() {
         return _cols;
     }
 
-    template<typename T>
-    T *Matrix<T>::data() {
+    template<typename T, Layout L>
+    uint64_t Matrix<T, 0, 0, L>::leading_dimension() {
+        return std::max<uint64_t>(1, L == Layout::RowMajor ? _cols : _rows);
+    }
+
+    template<typename T, Layout L>
+    T *Matrix<T, 0, 0, L>::data() {
         return _data.data();
     }
 
-    template<typename T>
-    Matrix<T>::Matrix(BaseArray<T> &right) {
-        _rows = right[0];
-        _cols = right[1];
-        _data = right;
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L>::Matrix(BaseArray<T> &right) : _data(right), _rows(right[0]), _cols(right[1]) {}
+
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L>::Matrix(BaseArray<T> &&right) : _rows(right[0]), _cols(right[1]) {
+        _data = std::move(right);
     }
 
-    template<typename T>
-    Matrix<T> Matrix<T>::operator+(const Matrix<T> &right) {
-        auto result = _data + right._data;
-        return Matrix<T>(result);
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L>::Matrix(MatrixView<T> right) : Matrix(right.rows(), right.cols()) {
+        copy(right, view());
+    }
+
+    template<typename T, Layout L>
+    MatrixView<T> Matrix<T, 0, 0, L>::view() {
+        if constexpr (L == Layout::RowMajor)
+            return MatrixView<T>(_data.data(), _rows, _cols, _cols, 1);
+        else
+            return MatrixView<T>(_data.data(), _rows, _cols, 1, _rows);
+    }
+
+    template<typename T, Layout L>
+    VectorView<T> Matrix<T, 0, 0, L>::row(uint64_t row) {
+        return view().row(row);
+    }
+
+    template<typename T, Layout L>
+    VectorView<T> Matrix<T, 0, 0, L>::col(uint64_t col) {
+        return view().col(col);
+    }
+
+    template<typename T, Layout L>
+    MatrixView<T> Matrix<T, 0, 0, L>::block(uint64_t row, uint64_t col, uint64_t rows, uint64_t cols) {
+        return view().block(row, col, rows, cols);
+    }
+
+    template<typename T, Layout L>
+    MatrixView<T> Matrix<T, 0, 0, L>::transpose() {
+        return view().transpose();
     }
 
+    template<typename T, Layout L>
+    template<typename E>
+    requires IsExpression<E>
+    Matrix<T, 0, 0, L>::Matrix(const E &expression) : _data(expression), _rows(0), _cols(0) {
+        if (_data.ndim() != 2)
+            throw std::invalid_argument("Matrix requires a two dimensional expression.");
+        if (expression.layout() != L)
+            throw std::invalid_argument("Layout mismatch for operation.");
+
+        _rows = _data[0];
+        _cols = _data[1];
+    }
+
+    template<typename T, Layout L>
+    template<typename E>
+    requires IsExpression<E>
+    Matrix<T, 0, 0, L> &Matrix<T, 0, 0, L>::operator=(const E &expression) {
+        if (expression.ndim() != 2)
+            throw std::invalid_argument("Matrix requires a two dimensional expression.");
+        if (expression.layout() != L)
+            throw std::invalid_argument("Layout mismatch for operation.");
+
+        _data = expression;
+        _rows = _data[0];
+        _cols = _data[1];
+
+        return *this;
+    }
+
+    template<typename T, Layout L>
+    ArrayExpression<T> Matrix<T, 0, 0, L>::expression() const {
+        return _data.expression(L);
+    }
+
+    // Copies source into destination tile by tile, so that both the reads and the
+    // writes stay within cache lines even when their storage orders differ.
     template<typename T>
-    Matrix<T> Matrix<T>::operator-(const Matrix<T> &right) {
-        auto result = _data - right._data;
-        return Matrix<T>(result);
+    void copy(MatrixView<T> source, MatrixView<T> destination) {
+        if (source.rows() != destination.rows() || source.cols() != destination.cols())
+            throw std::invalid_argument("Dimension size mismatch for operation.");
+
+        const uint64_t rows = source.rows(), cols = source.cols();
+        for (uint64_t i0 = 1; i0 <= rows; i0 += MINILA_LAYOUT_BLOCK)
+            for (uint64_t j0 = 1; j0 <= cols; j0 += MINILA_LAYOUT_BLOCK) {
+                const uint64_t i1 = std::min(rows, i0 + MINILA_LAYOUT_BLOCK - 1);
+                const uint64_t j1 = std::min(cols, j0 + MINILA_LAYOUT_BLOCK - 1);
+                for (uint64_t i = i0; i <= i1; i++)
+                    for (uint64_t j = j0; j <= j1; j++)
+                        destination(i, j) = source(i, j);
+            }
+    }
+
+    // Marks a matrix operand as transposed for the multiply backends: transpose(A)
+    // becomes a CblasTrans flag in blas:: and swapped indices in naive::, so A^T is
+    // never built. It holds a reference to A, like a view.
+    template<typename M>
+    struct Transpose {
+        M &matrix;
+
+        uint64_t rows() { return matrix.cols(); }
+
+        uint64_t cols() { return matrix.rows(); }
+
+        auto &at_unchecked(uint64_t row, uint64_t col) { return matrix.at_unchecked(col, row); }
+
+        auto view() { return matrix.view().transpose(); }
+    };
+
+    template<typename T, Layout L>
+    Transpose<Matrix<T, 0, 0, L>> transpose(Matrix<T, 0, 0, L> &matrix) {
+        return {matrix};
+    }
+
+    // Explicit, cache-blocked conversion between storage orders.
+    template<Layout To, typename T, Layout From>
+    Matrix<T, 0, 0, To> to_layout(Matrix<T, 0, 0, From> &M) {
+        if constexpr (To == From)
+            return M;
+        else
+            return Matrix<T, 0, 0, To>(M.view());
+    }
+
+    // Explicit conversion between element types, e.g. float to bf16 storage and
+    // back. Narrowing rounds to nearest even; bf16/fp16 widen through simd::widen.
+    template<typename To, typename T, Layout L>
+    Matrix<To, 0, 0, L> to_type(Matrix<T, 0, 0, L> &M) {
+        if constexpr (std::is_same_v<To, T>)
+            return M;
+        else {
+            auto result = Matrix<To, 0, 0, L>(M.rows(), M.cols());
+            const uint64_t n = M.rows() * M.cols();
+            ThreadPool::global().parallel_for(n, ThreadPool::grain(1), [&](uint64_t begin, uint64_t end) {
+                if constexpr (IsHalf<T> && std::is_same_v<To, float>)
+                    simd::widen(end - begin, M.data() + begin, result.data() + begin);
+                else
+                    for (uint64_t i = begin; i < end; i++)
+                        result.data()[i] = static_cast<To>(M.data()[i]);
+            });
+
+            return result;
+        }
     }
 
 };
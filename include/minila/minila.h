@@ -7,22 +7,44 @@
 #ifndef MINILA_MINILA_H
 #define MINILA_MINILA_H
 
+#include "allocator.h"
 #include "base.h"
+#include "batched.h"
 #include "blas_multiply.h"
+#include "blocked.h"
+#include "cholesky.h"
 #include "constants.h"
+#include "dispatch.h"
+#include "eigen.h"
+#include "expression.h"
+#include "fixed.h"
+#include "half.h"
 #include "integration.h"
+#include "layout.h"
 #include "linsolve.h"
 #include "lu.h"
 #include "matrix.h"
 #include "naive.h"
 #include "numerical.h"
+#include "operator_automatic.h"
+#include "operator_blocked.h"
 #include "operator_naive.h"
 #include "operator_performance.h"
+#include "operator_sparse.h"
 #include "processes/base.h"
 #include "processes/brownian.h"
 #include "processes/geometric.h"
 #include "print.h"
+#include "qr.h"
+#include "quantized.h"
+#include "randomized.h"
+#include "simd.h"
+#include "sparse.h"
+#include "strassen.h"
+#include "structured.h"
 #include "svd.h"
+#include "thread_pool.h"
 #include "vector.h"
+#include "view.h"
 
 #endif //MINILA_MINILA_H
@@ -7,22 +7,40 @@
 #ifndef MINILA_NAIVE_H
 #define MINILA_NAIVE_H
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <stdexcept>
 #include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
 #include "vector.h"
 
 namespace minila::naive {
 
+    // float/double operands of the same type go through the runtime-dispatched
+    // kernels in simd.h, as do bf16/fp16 operands against float ones (widened in
+    // registers); anything else takes the scalar loops.
+    template<typename T1, typename T2>
+    concept IsSimd = std::is_same_v<T1, T2> && simd::IsKernelType<T1>;
+
+    template<typename T1, typename T2>
+    concept IsWidening = IsHalf<T1> && std::is_same_v<T2, float>;
+
     // Vector * scalar
     template<typename T1, typename T2>
     inline auto multiply(Vector<T1> &left, T2 right) {
         using R = decltype(T1(0) + T2(0));
         auto result = Vector<R>(left.dimensions());
 
-        std::transform(left.data(), left.data() + left.dimensions(), result.data(),
-                       [&right](double element) { return element *= right; });
+        ThreadPool::global().parallel_for(result.dimensions(), ThreadPool::grain(1), [&](uint64_t begin, uint64_t end) {
+            if constexpr (IsSimd<T1, R>) {
+                std::copy(left.data() + begin, left.data() + end, result.data() + begin);
+                simd::scal<R>(end - begin, R(right), result.data() + begin);
+            } else
+                std::transform(left.data() + begin, left.data() + end, result.data() + begin,
+                               [&right](R element) { return element * right; });
+        });
 
         return result;
     }
@@ -33,8 +51,14 @@ namespace minila::naive {
         using R = decltype(T1(0) + T2(0));
         auto result = Vector<R>(right.dimensions());
 
-        std::transform(right.data(), right.data() + right.dimensions(), result.data(),
-                       [&left](double element) { return element *= left; });
+        ThreadPool::global().parallel_for(result.dimensions(), ThreadPool::grain(1), [&](uint64_t begin, uint64_t end) {
+            if constexpr (IsSimd<T1, R>) {
+                std::copy(right.data() + begin, right.data() + end, result.data() + begin);
+                simd::scal<R>(end - begin, R(left), result.data() + begin);
+            } else
+                std::transform(right.data() + begin, right.data() + end, result.data() + begin,
+                               [&left](R element) { return left * element; });
+        });
 
         return result;
     }
@@ -46,9 +70,16 @@ namespace minila::naive {
             throw std::invalid_argument("Invalid axis sizes on operation dot.");
 
         using R = decltype(T1(0) * T2(0));
-        R result = std::inner_product(left.data(), left.data() + left.dimensions(), right.data(), 0);
+        auto partial = [&](uint64_t begin, uint64_t end) {
+            if constexpr (IsSimd<T1, T2>)
+                return simd::dot<R>(end - begin, left.data() + begin, right.data() + begin);
+            else if constexpr (IsWidening<T1, T2>)
+                return simd::dot(end - begin, left.data() + begin, right.data() + begin);
+            else
+                return std::inner_product(left.data() + begin, left.data() + end, right.data() + begin, R(0));
+        };
 
-        return result;
+        return ThreadPool::global().parallel_reduce(left.dimensions(), ThreadPool::grain(1), R(0), partial);
     }
 
     // Matrix * Vector
@@ -60,9 +91,25 @@ namespace minila::naive {
         using R = decltype(T1(0) * T2(0));
         Vector<R> result(M.rows());
 
-        for (uint64_t i = 1; i <= result.dimensions(); i++)
-            for (uint64_t k = 1; k <= M.cols(); k++)
-                result(i) += M(i, k) * v(k);
+        // Rows are split across the pool.
+        const uint64_t m = M.rows(), n = M.cols();
+        ThreadPool::global().parallel_for(m, ThreadPool::grain(n), [&](uint64_t begin, uint64_t end) {
+            if constexpr (IsSimd<T1, T2>) {
+                simd::gemv<R>(end - begin, n, M.data() + begin * n, n, v.data(), result.data() + begin);
+                return;
+            } else if constexpr (IsWidening<T1, T2>) {
+                for (uint64_t i = begin; i < end; i++)
+                    result.data()[i] = simd::dot(n, M.data() + i * n, v.data());
+                return;
+            }
+
+            for (uint64_t i = begin + 1; i <= end; i++) {
+                R sum = 0;
+                for (uint64_t k = 1; k <= n; k++)
+                    sum += M.at_unchecked(i, k) * v.at_unchecked(k);
+                result.at_unchecked(i) = sum;
+            }
+        });
 
         return result;
     }
@@ -76,9 +123,22 @@ namespace minila::naive {
         using R = decltype(T1(0) * T2(0));
         Vector<R> result(M.cols());
 
-        for (uint64_t i = 1; i <= result.dimensions(); i++)
-            for (uint64_t k = 1; k <= M.cols(); k++)
-                result(i) += v(k) * M(k, i);
+        // Walks M row by row, so the inner loop runs over contiguous memory; columns
+        // are split across the pool.
+        const uint64_t m = M.rows(), n = M.cols();
+        ThreadPool::global().parallel_for(n, ThreadPool::grain(m), [&](uint64_t begin, uint64_t end) {
+            if constexpr (IsSimd<T1, T2>) {
+                for (uint64_t k = 0; k < m; k++)
+                    simd::axpy<R>(end - begin, v.data()[k], M.data() + k * n + begin, result.data() + begin);
+                return;
+            }
+
+            for (uint64_t k = 1; k <= m; k++) {
+                auto v_k = v.at_unchecked(k);
+                for (uint64_t i = begin + 1; i <= end; i++)
+                    result.at_unchecked(i) += v_k * M.at_unchecked(k, i);
+            }
+        });
 
         return result;
     }
@@ -92,18 +152,113 @@ namespace minila::naive {
         using R = decltype(T1(0) * T2(0));
         Matrix<R> result(left.rows(), right.cols());
 
-        for (uint64_t i = 1; i <= result.rows(); i++)
-            for (uint64_t k = 1; k <= left.cols(); k++)
-                for (uint64_t j = 1; j <= result.cols(); j++)
-                    result(i, j) += left(i, k) * right(k, j);
+        // Rows of the result are split across the pool.
+        const uint64_t m = result.rows(), n = result.cols(), p = left.cols();
+        ThreadPool::global().parallel_for(m, ThreadPool::grain(n * p), [&](uint64_t begin, uint64_t end) {
+            if constexpr (IsSimd<T1, T2>) {
+                for (uint64_t i = begin; i < end; i++)
+                    for (uint64_t k = 0; k < p; k++)
+                        simd::axpy<R>(n, left.data()[i * p + k], right.data() + k * n, result.data() + i * n);
+                return;
+            }
+
+            for (uint64_t i = begin + 1; i <= end; i++)
+                for (uint64_t k = 1; k <= p; k++) {
+                    auto left_ik = left.at_unchecked(i, k);
+                    for (uint64_t j = 1; j <= n; j++)
+                        result.at_unchecked(i, j) += left_ik * right.at_unchecked(k, j);
+                }
+        });
+
+        return result;
+    }
+
+    // Matrix^T * Vector; the rows of M are walked as in Vector * Matrix.
+    template<typename T1, typename T2>
+    auto multiply(Transpose<Matrix<T1>> M, Vector<T2> &v) {
+        return multiply(v, M.matrix);
+    }
+
+    // Vector * Matrix^T; the rows of M are walked as in Matrix * Vector.
+    template<typename T1, typename T2>
+    auto multiply(Vector<T1> &v, Transpose<Matrix<T2>> M) {
+        return multiply(M.matrix, v);
+    }
+
+    // Matrix^T * Matrix; row k of left scales row k of right into every row of the
+    // result, so all accesses stay row-wise.
+    template<typename T1, typename T2>
+    auto multiply(Transpose<Matrix<T1>> left, Matrix<T2> &right) {
+        if (left.cols() != right.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation naive::multiply.");
+
+        using R = decltype(T1(0) * T2(0));
+        Matrix<R> result(left.rows(), right.cols());
+
+        // Rows of the result are split across the pool.
+        const uint64_t m = result.rows(), n = result.cols(), p = left.cols();
+        ThreadPool::global().parallel_for(m, ThreadPool::grain(n * p), [&](uint64_t begin, uint64_t end) {
+            if constexpr (IsSimd<T1, T2>) {
+                const T1 *A = left.matrix.data();
+                for (uint64_t k = 0; k < p; k++)
+                    for (uint64_t i = begin; i < end; i++)
+                        simd::axpy<R>(n, A[k * m + i], right.data() + k * n, result.data() + i * n);
+                return;
+            }
+
+            for (uint64_t k = 1; k <= p; k++)
+                for (uint64_t i = begin + 1; i <= end; i++) {
+                    auto left_ik = left.at_unchecked(i, k);
+                    for (uint64_t j = 1; j <= n; j++)
+                        result.at_unchecked(i, j) += left_ik * right.at_unchecked(k, j);
+                }
+        });
+
+        return result;
+    }
+
+    // Matrix * Matrix^T; every element is a dot product of two rows.
+    template<typename T1, typename T2>
+    auto multiply(Matrix<T1> &left, Transpose<Matrix<T2>> right) {
+        if (left.cols() != right.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation naive::multiply.");
+
+        using R = decltype(T1(0) * T2(0));
+        Matrix<R> result(left.rows(), right.cols());
+
+        // Rows of the result are split across the pool.
+        const uint64_t m = result.rows(), n = result.cols(), p = left.cols();
+        ThreadPool::global().parallel_for(m, ThreadPool::grain(n * p), [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++)
+                for (uint64_t j = 0; j < n; j++) {
+                    const T1 *a = left.data() + i * p;
+                    const T2 *b = right.matrix.data() + j * p;
+                    if constexpr (IsSimd<T1, T2>)
+                        result.data()[i * n + j] = simd::dot<R>(p, a, b);
+                    else
+                        result.data()[i * n + j] = std::inner_product(a, a + p, b, R(0));
+                }
+        });
+
+        return result;
+    }
+
+    // Matrix^T * Matrix^T, computed as (right * left)^T.
+    template<typename T1, typename T2>
+    auto multiply(Transpose<Matrix<T1>> left, Transpose<Matrix<T2>> right) {
+        auto product = multiply(right.matrix, left.matrix);
+
+        using R = decltype(T1(0) * T2(0));
+        Matrix<R> result(product.cols(), product.rows());
+        copy(product.transpose(), result.view());
 
         return result;
     }
 
-    // Absolute value of vector
+    // Absolute value (Euclidean norm) of vector
     template<typename T>
     inline auto abs(Vector<T> &left) {
-        return dot(left, left);
+        return std::sqrt(dot(left, left));
     }
 
     // Cosine of angle between Vector
@@ -0,0 +1,22 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_OPERATOR_BLOCKED_H
+#define MINILA_OPERATOR_BLOCKED_H
+
+#include "blocked.h"
+
+namespace minila::operators::blocked {
+
+    // Matrix * Matrix
+    template<typename T, Layout L1, Layout L2>
+    auto operator*(Matrix<T, 0, 0, L1> &left, Matrix<T, 0, 0, L2> &right) {
+        return minila::blocked::multiply(left, right);
+    }
+
+};
+
+#endif //MINILA_OPERATOR_BLOCKED_H
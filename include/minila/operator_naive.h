@@ -53,6 +53,36 @@ namespace minila::operators::naive {
         return minila::naive::multiply(left, right);
     }
 
+    // Matrix^T * Matrix
+    template<typename T1, typename T2>
+    auto operator*(Transpose<Matrix<T1>> left, Matrix<T2> &right) {
+        return minila::naive::multiply(left, right);
+    }
+
+    // Matrix * Matrix^T
+    template<typename T1, typename T2>
+    auto operator*(Matrix<T1> &left, Transpose<Matrix<T2>> right) {
+        return minila::naive::multiply(left, right);
+    }
+
+    // Matrix^T * Matrix^T
+    template<typename T1, typename T2>
+    auto operator*(Transpose<Matrix<T1>> left, Transpose<Matrix<T2>> right) {
+        return minila::naive::multiply(left, right);
+    }
+
+    // Matrix^T * Vector
+    template<typename T1, typename T2>
+    auto operator*(Transpose<Matrix<T1>> left, Vector<T2> &right) {
+        return minila::naive::multiply(left, right);
+    }
+
+    // Vector * Matrix^T
+    template<typename T1, typename T2>
+    auto operator*(Vector<T1> &left, Transpose<Matrix<T2>> right) {
+        return minila::naive::multiply(left, right);
+    }
+
 };
 
 #endif //MINILA_OPERATOR_NAIVE_H
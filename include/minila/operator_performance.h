@@ -8,6 +8,7 @@
 #define MINILA_OPERATOR_PERFORMANCE_H
 
 #include "blas_multiply.h"
+#include "structured.h"
 
 namespace minila::operators::performance {
 
@@ -43,20 +44,12 @@ namespace minila::operators::performance {
 
     // Angle between vectors
     float operator%(Vector<float> &left, Vector<float> &right) {
-        float abs_l = minila::blas::dot(left, left);
-        float abs_r = minila::blas::dot(right, right);
-
-        auto cosine = minila::blas::dot(left, right) / (abs_l * abs_r);
-        return std::acos(cosine);
+        return minila::blas::angle(left, right);
     }
 
     // Angle between vectors
     double operator%(Vector<double> &left, Vector<double> &right) {
-        double abs_l = minila::blas::dot(left, left);
-        double abs_r = minila::blas::dot(right, right);
-
-        auto cosine = minila::blas::dot(left, right) / (abs_l * abs_r);
-        return std::acos(cosine);
+        return minila::blas::angle(left, right);
     }
 
     // Matrix * Vector
@@ -89,6 +82,216 @@ namespace minila::operators::performance {
         return minila::blas::multiply(left, right);
     }
 
+    // Matrix^T * Matrix
+    Matrix<float> operator*(Transpose<Matrix<float>> left, Matrix<float> &right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Matrix^T * Matrix
+    Matrix<double> operator*(Transpose<Matrix<double>> left, Matrix<double> &right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Matrix * Matrix^T
+    Matrix<float> operator*(Matrix<float> &left, Transpose<Matrix<float>> right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Matrix * Matrix^T
+    Matrix<double> operator*(Matrix<double> &left, Transpose<Matrix<double>> right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Matrix^T * Matrix^T
+    Matrix<float> operator*(Transpose<Matrix<float>> left, Transpose<Matrix<float>> right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Matrix^T * Matrix^T
+    Matrix<double> operator*(Transpose<Matrix<double>> left, Transpose<Matrix<double>> right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Matrix^T * Vector
+    Vector<float> operator*(Transpose<Matrix<float>> left, Vector<float> &right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Matrix^T * Vector
+    Vector<double> operator*(Transpose<Matrix<double>> left, Vector<double> &right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Vector * Matrix^T
+    Vector<float> operator*(Vector<float> &left, Transpose<Matrix<float>> right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Vector * Matrix^T
+    Vector<double> operator*(Vector<double> &left, Transpose<Matrix<double>> right) {
+        return minila::blas::multiply(left, right);
+    }
+
+    // Vector *= scalar, in place
+    Vector<float> &operator*=(Vector<float> &left, float right) {
+        cblas_sscal(left.dimensions(), right, left.data(), 1);
+        return left;
+    }
+
+    // Vector *= scalar, in place
+    Vector<double> &operator*=(Vector<double> &left, double right) {
+        cblas_dscal(left.dimensions(), right, left.data(), 1);
+        return left;
+    }
+
+    // Matrix *= scalar, in place
+    Matrix<float> &operator*=(Matrix<float> &left, float right) {
+        cblas_sscal(left.rows() * left.cols(), right, left.data(), 1);
+        return left;
+    }
+
+    // Matrix *= scalar, in place
+    Matrix<double> &operator*=(Matrix<double> &left, double right) {
+        cblas_dscal(left.rows() * left.cols(), right, left.data(), 1);
+        return left;
+    }
+
+    // Matrix *= Matrix; the product needs a temporary, which then replaces left's storage.
+    Matrix<float> &operator*=(Matrix<float> &left, Matrix<float> &right) {
+        left = minila::blas::multiply(left, right);
+        return left;
+    }
+
+    // Matrix *= Matrix; the product needs a temporary, which then replaces left's storage.
+    Matrix<double> &operator*=(Matrix<double> &left, Matrix<double> &right) {
+        left = minila::blas::multiply(left, right);
+        return left;
+    }
+
+    // Matrix += Matrix * Matrix, fused into a single gemm
+    Matrix<float> &operator+=(Matrix<float> &left, minila::blas::Product<Matrix<float>, Matrix<float>, float> product) {
+        minila::blas::gemm_into(left, product.left, product.right, product.alpha, float(1));
+        return left;
+    }
+
+    // Matrix -= Matrix * Matrix, fused into a single gemm
+    Matrix<float> &operator-=(Matrix<float> &left, minila::blas::Product<Matrix<float>, Matrix<float>, float> product) {
+        minila::blas::gemm_into(left, product.left, product.right, -product.alpha, float(1));
+        return left;
+    }
+
+    // Matrix += Matrix * Matrix, fused into a single gemm
+    Matrix<double> &operator+=(Matrix<double> &left,
+                               minila::blas::Product<Matrix<double>, Matrix<double>, double> product) {
+        minila::blas::gemm_into(left, product.left, product.right, product.alpha, double(1));
+        return left;
+    }
+
+    // Matrix -= Matrix * Matrix, fused into a single gemm
+    Matrix<double> &operator-=(Matrix<double> &left,
+                               minila::blas::Product<Matrix<double>, Matrix<double>, double> product) {
+        minila::blas::gemm_into(left, product.left, product.right, -product.alpha, double(1));
+        return left;
+    }
+
+    // Vector += Matrix * Vector, fused into a single gemv
+    Vector<float> &operator+=(Vector<float> &left, minila::blas::Product<Matrix<float>, Vector<float>, float> product) {
+        minila::blas::gemv_into(left, product.left, product.right, product.alpha, float(1));
+        return left;
+    }
+
+    // Vector -= Matrix * Vector, fused into a single gemv
+    Vector<float> &operator-=(Vector<float> &left, minila::blas::Product<Matrix<float>, Vector<float>, float> product) {
+        minila::blas::gemv_into(left, product.left, product.right, -product.alpha, float(1));
+        return left;
+    }
+
+    // Vector += Matrix * Vector, fused into a single gemv
+    Vector<double> &operator+=(Vector<double> &left,
+                               minila::blas::Product<Matrix<double>, Vector<double>, double> product) {
+        minila::blas::gemv_into(left, product.left, product.right, product.alpha, double(1));
+        return left;
+    }
+
+    // Vector -= Matrix * Vector, fused into a single gemv
+    Vector<double> &operator-=(Vector<double> &left,
+                               minila::blas::Product<Matrix<double>, Vector<double>, double> product) {
+        minila::blas::gemv_into(left, product.left, product.right, -product.alpha, double(1));
+        return left;
+    }
+
+    // SymmetricMatrix * Vector
+    template<typename T>
+    auto operator*(SymmetricMatrix<T> &left, Vector<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // SymmetricMatrix * Matrix
+    template<typename T>
+    auto operator*(SymmetricMatrix<T> &left, Matrix<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // Matrix * SymmetricMatrix
+    template<typename T>
+    auto operator*(Matrix<T> &left, SymmetricMatrix<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // TriangularMatrix * Vector
+    template<typename T>
+    auto operator*(TriangularMatrix<T> &left, Vector<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // TriangularMatrix * Matrix
+    template<typename T>
+    auto operator*(TriangularMatrix<T> &left, Matrix<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // Matrix * TriangularMatrix
+    template<typename T>
+    auto operator*(Matrix<T> &left, TriangularMatrix<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // BandMatrix * Vector
+    template<typename T>
+    auto operator*(BandMatrix<T> &left, Vector<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // SymmetricBandMatrix * Vector
+    template<typename T>
+    auto operator*(SymmetricBandMatrix<T> &left, Vector<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // DiagonalMatrix * Vector
+    template<typename T>
+    auto operator*(DiagonalMatrix<T> &left, Vector<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // Vector * DiagonalMatrix
+    template<typename T>
+    auto operator*(Vector<T> &left, DiagonalMatrix<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // DiagonalMatrix * Matrix
+    template<typename T>
+    auto operator*(DiagonalMatrix<T> &left, Matrix<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
+    // Matrix * DiagonalMatrix
+    template<typename T>
+    auto operator*(Matrix<T> &left, DiagonalMatrix<T> &right) {
+        return minila::structured::multiply(left, right);
+    }
+
 };
 
 #endif //MINILA_OPERATOR_PERFORMANCE_H
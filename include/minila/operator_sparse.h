@@ -0,0 +1,40 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_OPERATOR_SPARSE_H
+#define MINILA_OPERATOR_SPARSE_H
+
+#include "sparse.h"
+
+namespace minila::operators::sparse {
+
+    // SparseMatrix * Vector
+    template<typename T, Layout L>
+    auto operator*(SparseMatrix<T, L> &left, Vector<T> &right) {
+        return minila::sparse::multiply(left, right);
+    }
+
+    // Vector * SparseMatrix
+    template<typename T, Layout L>
+    auto operator*(Vector<T> &left, SparseMatrix<T, L> &right) {
+        return minila::sparse::multiply(left, right);
+    }
+
+    // SparseMatrix * Matrix
+    template<typename T, Layout L>
+    auto operator*(SparseMatrix<T, L> &left, Matrix<T> &right) {
+        return minila::sparse::multiply(left, right);
+    }
+
+    // Matrix * SparseMatrix
+    template<typename T, Layout L>
+    auto operator*(Matrix<T> &left, SparseMatrix<T, L> &right) {
+        return minila::sparse::multiply(left, right);
+    }
+
+};
+
+#endif //MINILA_OPERATOR_SPARSE_H
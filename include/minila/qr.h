@@ -0,0 +1,187 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_QR_H
+#define MINILA_QR_H
+
+#include <algorithm>
+#include <lapacke.h>
+#include <stdexcept>
+#include <type_traits>
+#include "layout.h"
+#include "matrix.h"
+#include "vector.h"
+
+namespace minila {
+
+    // QR factorization A P = Q R, laid out like ?geqrf: R in the upper triangle
+    // of D and the Householder vectors of Q below it, scaled by tau. P is the
+    // identity unless the factorization was column pivoted (?geqp3).
+    template<typename T, Layout L = Layout::RowMajor>
+    struct QR {
+        Matrix<T, 0, 0, L> D; // Store the decomposition
+        Vector<T> tau; // min(M,N) Householder scalars
+        Vector<int> jpvt; // Column j of A P is column jpvt(j) of A; empty without pivoting
+
+        int info = 0; // Stores the info result for calculation
+
+        // min(M,N) x N upper triangular factor.
+        Matrix<T, 0, 0, L> R();
+
+        // M x min(M,N) factor with orthonormal columns, through ?orgqr.
+        Matrix<T, 0, 0, L> Q();
+
+        // Least-squares solution of A x = b for M >= N and full column rank:
+        // x = P R^-1 (Q^T b), through ?ormqr and ?trtrs. Never forms A^T A.
+        Vector<T> solve(Vector<T> &b);
+
+        template<Layout LB>
+        Matrix<T, 0, 0, LB> solve(Matrix<T, 0, 0, LB> &B);
+
+    private:
+        void _solve(uint64_t nrhs, T *B, uint64_t ldb);
+
+        // Row j of X moves to row jpvt(j).
+        template<Layout LX>
+        Matrix<T, 0, 0, LX> _unpivot(Matrix<T, 0, 0, LX> &&X);
+    };
+
+    // Column-major matrices are factored in place by LAPACK. Row-major ones go
+    // through the LAPACKE row-major interface, which transposes internally.
+    template<typename T, Layout L>
+    QR<T, L> qr(Matrix<T, 0, 0, L> &M, bool pivoting = false) {
+        auto D = Matrix(M);
+        auto tau = Vector<T>(std::max<uint64_t>(1, std::min(M.rows(), M.cols())));
+        auto jpvt = pivoting ? Vector<int>(std::max<uint64_t>(1, M.cols())) : Vector<int>();
+        if (pivoting)
+            std::fill_n(jpvt.data(), jpvt.dimensions(), 0);
+
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int info;
+        if constexpr (std::is_same_v<T, float>)
+            info = pivoting ? LAPACKE_sgeqp3(layout, D.rows(), D.cols(), D.data(), D.leading_dimension(), jpvt.data(),
+                                             tau.data())
+                            : LAPACKE_sgeqrf(layout, D.rows(), D.cols(), D.data(), D.leading_dimension(), tau.data());
+        else if constexpr (std::is_same_v<T, double>)
+            info = pivoting ? LAPACKE_dgeqp3(layout, D.rows(), D.cols(), D.data(), D.leading_dimension(), jpvt.data(),
+                                             tau.data())
+                            : LAPACKE_dgeqrf(layout, D.rows(), D.cols(), D.data(), D.leading_dimension(), tau.data());
+        else
+            throw std::runtime_error("Unsupported type for QR.");
+
+        return QR<T, L>{std::move(D), std::move(tau), std::move(jpvt), info};
+    }
+
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L> QR<T, L>::R() {
+        const uint64_t k = std::min(D.rows(), D.cols());
+
+        auto result = Matrix<T, 0, 0, L>(k, D.cols());
+        for (uint64_t i = 1; i <= k; i++)
+            for (uint64_t j = i; j <= D.cols(); j++)
+                result.at_unchecked(i, j) = D.at_unchecked(i, j);
+
+        return result;
+    }
+
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L> QR<T, L>::Q() {
+        const uint64_t k = std::min(D.rows(), D.cols());
+
+        auto result = Matrix<T, 0, 0, L>(D.view().block(1, 1, D.rows(), k));
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int status;
+        if constexpr (std::is_same_v<T, float>)
+            status = LAPACKE_sorgqr(layout, result.rows(), k, k, result.data(), result.leading_dimension(), tau.data());
+        else if constexpr (std::is_same_v<T, double>)
+            status = LAPACKE_dorgqr(layout, result.rows(), k, k, result.data(), result.leading_dimension(), tau.data());
+        else
+            throw std::runtime_error("Unsupported type for QR.");
+
+        if (status != 0)
+            throw std::runtime_error("LAPACK error in QR::Q.");
+
+        return result;
+    }
+
+    // B <- R^-1 (Q^T B) in its leading N rows, for nrhs columns of M rows stored
+    // in the layout of D.
+    template<typename T, Layout L>
+    void QR<T, L>::_solve(uint64_t nrhs, T *B, uint64_t ldb) {
+        const uint64_t m = D.rows(), n = D.cols();
+        if (m < n)
+            throw std::invalid_argument("QR::solve needs at least as many rows as columns; use lstsq.");
+        if (info != 0)
+            throw std::runtime_error("LAPACK error in QR::solve.");
+
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+
+        int result;
+        if constexpr (std::is_same_v<T, float>) {
+            result = LAPACKE_sormqr(layout, 'L', 'T', m, nrhs, n, D.data(), D.leading_dimension(), tau.data(), B,
+                                    ldb);
+            if (result == 0)
+                result = LAPACKE_strtrs(layout, 'U', 'N', 'N', n, nrhs, D.data(), D.leading_dimension(), B, ldb);
+        } else if constexpr (std::is_same_v<T, double>) {
+            result = LAPACKE_dormqr(layout, 'L', 'T', m, nrhs, n, D.data(), D.leading_dimension(), tau.data(), B,
+                                    ldb);
+            if (result == 0)
+                result = LAPACKE_dtrtrs(layout, 'U', 'N', 'N', n, nrhs, D.data(), D.leading_dimension(), B, ldb);
+        } else
+            throw std::runtime_error("Unsupported type for QR.");
+
+        if (result > 0)
+            throw std::runtime_error("Rank deficient matrix in QR::solve.");
+        if (result != 0)
+            throw std::runtime_error("LAPACK error in QR::solve.");
+    }
+
+    template<typename T, Layout L>
+    template<Layout LX>
+    Matrix<T, 0, 0, LX> QR<T, L>::_unpivot(Matrix<T, 0, 0, LX> &&X) {
+        if (jpvt.dimensions() == 0)
+            return std::move(X);
+
+        auto result = Matrix<T, 0, 0, LX>(X.rows(), X.cols());
+        for (uint64_t j = 1; j <= X.rows(); j++)
+            for (uint64_t c = 1; c <= X.cols(); c++)
+                result.at_unchecked(jpvt.data()[j - 1], c) = X.at_unchecked(j, c);
+
+        return result;
+    }
+
+    template<typename T, Layout L>
+    Vector<T> QR<T, L>::solve(Vector<T> &b) {
+        if (D.rows() != b.dimensions())
+            throw std::invalid_argument("Invalid axis sizes on operation QR::solve.");
+
+        auto y = Vector<T>(b);
+        _solve(1, y.data(), L == Layout::ColMajor ? std::max<uint64_t>(1, y.dimensions()) : 1);
+
+        auto x = Vector<T>(D.cols());
+        for (uint64_t j = 1; j <= D.cols(); j++)
+            x.at_unchecked(jpvt.dimensions() ? jpvt.data()[j - 1] : j) = y.at_unchecked(j);
+
+        return x;
+    }
+
+    template<typename T, Layout L>
+    template<Layout LB>
+    Matrix<T, 0, 0, LB> QR<T, L>::solve(Matrix<T, 0, 0, LB> &B) {
+        if (D.rows() != B.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation QR::solve.");
+
+        auto Y = to_layout<L>(B);
+        _solve(Y.cols(), Y.data(), Y.leading_dimension());
+
+        return _unpivot(Matrix<T, 0, 0, LB>(Y.view().block(1, 1, D.cols(), Y.cols())));
+    }
+
+};
+
+#endif //MINILA_QR_H
@@ -0,0 +1,134 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_QUANTIZED_H
+#define MINILA_QUANTIZED_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace minila {
+
+    // Symmetric int8 quantization: M(i, j) ~ scales(i) * values(i, j) for a
+    // RowMajor matrix (one scale per row) and scales(j) * values(i, j) for a
+    // ColMajor one (one scale per column), so scales always follow the contiguous
+    // axis. Values lie in [-127, 127] and take a quarter of the memory of floats.
+    template<Layout L = Layout::RowMajor>
+    struct QuantizedMatrix {
+        Matrix<int8_t, 0, 0, L> values;
+        Vector<float> scales;
+
+        uint64_t rows() { return values.rows(); }
+
+        uint64_t cols() { return values.cols(); }
+    };
+
+};
+
+namespace minila::quantized {
+
+    constexpr uint64_t MINILA_QUANTIZED_BLOCK = 256; // Columns of B reused from cache per row sweep.
+
+    // Quantizes n contiguous values with one scale, max |x| / 127; returns the scale.
+    inline float _quantize(uint64_t n, const float *x, int8_t *q) {
+        float peak = 0;
+        for (uint64_t i = 0; i < n; i++)
+            peak = std::max(peak, std::fabs(x[i]));
+
+        const float scale = peak / 127.0f, inverse = peak > 0 ? 127.0f / peak : 0.0f;
+        for (uint64_t i = 0; i < n; i++)
+            q[i] = int8_t(std::clamp(std::nearbyint(x[i] * inverse), -127.0f, 127.0f));
+
+        return scale;
+    }
+
+    // Quantizes M with one scale per row (To = RowMajor) or per column (To = ColMajor).
+    template<Layout To = Layout::RowMajor, Layout From>
+    QuantizedMatrix<To> quantize(Matrix<float, 0, 0, From> &M) {
+        auto source = to_layout<To>(M);
+        QuantizedMatrix<To> result{Matrix<int8_t, 0, 0, To>(M.rows(), M.cols()),
+                                   Vector<float>(To == Layout::RowMajor ? M.rows() : M.cols())};
+
+        // Line length along the scaled axis; an empty line keeps its zero scale.
+        const uint64_t lines = result.scales.dimensions(), n = To == Layout::RowMajor ? M.cols() : M.rows();
+        if (n == 0)
+            return result;
+
+        ThreadPool::global().parallel_for(lines, ThreadPool::grain(n), [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++)
+                result.scales.data()[i] = _quantize(n, source.data() + i * n, result.values.data() + i * n);
+        });
+
+        return result;
+    }
+
+    // Back to floats, in the storage order of Q.
+    template<Layout L>
+    Matrix<float, 0, 0, L> dequantize(QuantizedMatrix<L> &Q) {
+        auto result = Matrix<float, 0, 0, L>(Q.rows(), Q.cols());
+
+        const uint64_t lines = Q.scales.dimensions(), n = L == Layout::RowMajor ? Q.cols() : Q.rows();
+        for (uint64_t i = 0; i < lines; i++)
+            for (uint64_t k = 0; k < n; k++)
+                result.data()[i * n + k] = Q.scales.data()[i] * float(Q.values.data()[i * n + k]);
+
+        return result;
+    }
+
+    // Quantized Matrix * Vector: x is quantized on the fly with a single scale,
+    // each row is an int8 dot product accumulated in int32, and the result is
+    // rescaled to float.
+    inline Vector<float> multiply(QuantizedMatrix<Layout::RowMajor> &A, Vector<float> &x) {
+        if (A.cols() != x.dimensions())
+            throw std::invalid_argument("Invalid axis sizes on operation quantized::multiply.");
+
+        const uint64_t m = A.rows(), n = A.cols();
+        Vector<int8_t> q(n);
+        const float scale = _quantize(n, x.data(), q.data());
+
+        Vector<float> result(m);
+        ThreadPool::global().parallel_for(m, ThreadPool::grain(n), [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++)
+                result.data()[i] = A.scales.data()[i] * scale *
+                                   float(simd::dot(n, A.values.data() + i * n, q.data()));
+        });
+
+        return result;
+    }
+
+    // Quantized Matrix * Matrix, for A quantized by rows and B by columns: every
+    // entry is then one contiguous int8 dot product, rescaled by both scales.
+    // Column blocks of B are swept by all rows while they are in cache.
+    inline Matrix<float> multiply(QuantizedMatrix<Layout::RowMajor> &A, QuantizedMatrix<Layout::ColMajor> &B) {
+        if (A.cols() != B.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation quantized::multiply.");
+
+        const uint64_t m = A.rows(), n = B.cols(), p = A.cols();
+        Matrix<float> result(m, n);
+
+        for (uint64_t j0 = 0; j0 < n; j0 += MINILA_QUANTIZED_BLOCK) {
+            const uint64_t j1 = std::min(n, j0 + MINILA_QUANTIZED_BLOCK);
+            ThreadPool::global().parallel_for(m, ThreadPool::grain((j1 - j0) * p), [&](uint64_t begin, uint64_t end) {
+                for (uint64_t i = begin; i < end; i++)
+                    for (uint64_t j = j0; j < j1; j++)
+                        result.data()[i * n + j] = A.scales.data()[i] * B.scales.data()[j] *
+                                                   float(simd::dot(p, A.values.data() + i * p,
+                                                                   B.values.data() + j * p));
+            });
+        }
+
+        return result;
+    }
+
+};
+
+#endif //MINILA_QUANTIZED_H
@@ -0,0 +1,103 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_RANDOMIZED_H
+#define MINILA_RANDOMIZED_H
+
+#include <algorithm>
+#include <lapacke.h>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include "blas_multiply.h"
+#include "layout.h"
+#include "matrix.h"
+#include "simd.h"
+#include "svd.h"
+#include "vector.h"
+
+namespace minila::randomized {
+
+    // Randomized truncated SVD (Halko, Martinsson and Tropp, "Finding structure
+    // with randomness", 2011): the range of M is sketched by M times a Gaussian
+    // test matrix of rank + oversampling columns, sharpened by power iterations,
+    // and the small projection Q^T M is decomposed exactly. Costs O(mn(k + p))
+    // instead of O(mn min(m, n)); accurate when the spectrum decays past rank.
+    constexpr uint64_t MINILA_RANDOMIZED_OVERSAMPLING = 10; // Extra sketch columns beyond the rank.
+    constexpr uint64_t MINILA_RANDOMIZED_POWER = 2; // Power iterations; more for slowly decaying spectra.
+
+    // Replaces the columns of Y (m >= cols) by an orthonormal basis of their
+    // span, through ?geqrf and ?orgqr.
+    template<typename T>
+    int _orthonormalize(Matrix<T, 0, 0, Layout::ColMajor> &Y) {
+        const uint64_t m = Y.rows(), n = Y.cols();
+        Vector<T> tau(std::max<uint64_t>(1, n));
+
+        int info;
+        if constexpr (std::is_same_v<T, float>) {
+            info = LAPACKE_sgeqrf(LAPACK_COL_MAJOR, m, n, Y.data(), Y.leading_dimension(), tau.data());
+            if (info == 0)
+                info = LAPACKE_sorgqr(LAPACK_COL_MAJOR, m, n, n, Y.data(), Y.leading_dimension(), tau.data());
+        } else if constexpr (std::is_same_v<T, double>) {
+            info = LAPACKE_dgeqrf(LAPACK_COL_MAJOR, m, n, Y.data(), Y.leading_dimension(), tau.data());
+            if (info == 0)
+                info = LAPACKE_dorgqr(LAPACK_COL_MAJOR, m, n, n, Y.data(), Y.leading_dimension(), tau.data());
+        }
+
+        return info;
+    }
+
+    // Leading rank singular triplets of M: U is m x rank, s holds rank values
+    // and V is rank x n (V^T, as in svd()). The sketch is drawn from seed, so
+    // results are reproducible.
+    template<typename T, Layout L>
+    requires simd::IsKernelType<T>
+    SVD<T, L> svd(Matrix<T, 0, 0, L> &M, uint64_t rank, uint64_t oversampling = MINILA_RANDOMIZED_OVERSAMPLING,
+                  uint64_t power = MINILA_RANDOMIZED_POWER, uint64_t seed = 0) {
+        const uint64_t m = M.rows(), n = M.cols();
+        if (rank == 0 || rank > std::min(m, n))
+            throw std::invalid_argument("Invalid rank on operation randomized::svd.");
+
+        const uint64_t l = std::min(rank + oversampling, std::min(m, n));
+
+        std::mt19937_64 generator(seed);
+        std::normal_distribution<T> normal;
+        Matrix<T, 0, 0, Layout::ColMajor> Omega(n, l), Q(m, l), Z(n, l);
+        std::generate_n(Omega.data(), n * l, [&] { return normal(generator); });
+
+        // Q = orth(M Omega), then Q = orth(M orth(M^T Q)) per power iteration.
+        blas::_gemm(T(1), M.view(), Omega.view(), T(0), Q.view());
+        int info = _orthonormalize(Q);
+        for (uint64_t i = 0; i < power && info == 0; i++) {
+            blas::_gemm(T(1), M.view().transpose(), Q.view(), T(0), Z.view());
+            info = _orthonormalize(Z);
+            if (info == 0) {
+                blas::_gemm(T(1), M.view(), Z.view(), T(0), Q.view());
+                info = _orthonormalize(Q);
+            }
+        }
+        if (info != 0)
+            return SVD<T, L>{Matrix<T, 0, 0, L>(), Vector<T>(), Matrix<T, 0, 0, L>(), info};
+
+        // B = Q^T M is l x n; its thin SVD B = W S V^T gives M ~ (Q W) S V^T.
+        Matrix<T, 0, 0, L> B(l, n);
+        blas::_gemm(T(1), Q.view().transpose(), M.view(), T(0), B.view());
+        auto core = minila::svd(B, SVDOptions{SVDJob::Thin, SVDDriver::DivideAndConquer, true});
+        if (core.info != 0)
+            return SVD<T, L>{Matrix<T, 0, 0, L>(), Vector<T>(), Matrix<T, 0, 0, L>(), core.info};
+
+        Matrix<T, 0, 0, L> U(m, rank);
+        blas::_gemm(T(1), Q.view(), core.U.view().block(1, 1, l, rank), T(0), U.view());
+
+        Vector<T> s(rank);
+        std::copy(core.s.data(), core.s.data() + rank, s.data());
+
+        return SVD<T, L>{std::move(U), std::move(s), Matrix<T, 0, 0, L>(core.V.view().block(1, 1, rank, n)), 0};
+    }
+
+};
+
+#endif //MINILA_RANDOMIZED_H
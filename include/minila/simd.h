@@ -0,0 +1,516 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_SIMD_H
+#define MINILA_SIMD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include "half.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MINILA_SIMD_X86
+#endif
+
+namespace minila::simd {
+
+    // Vectorized float/double kernels for the naive backend. Each kernel is built
+    // once per instruction set (SSE2, AVX2+FMA, AVX-512F) and the widest one the
+    // CPU supports is picked at runtime, falling back to scalar code elsewhere.
+    // All pointers are raw, contiguous and may be unaligned.
+
+    enum class Level {
+        Scalar,
+        SSE,
+        AVX2,
+        AVX512
+    };
+
+    // Widest instruction set supported by this CPU (queried once through CPUID).
+    inline Level detected() {
+        static const Level level = [] {
+#ifdef MINILA_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return Level::AVX512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return Level::AVX2;
+            if (__builtin_cpu_supports("sse2"))
+                return Level::SSE;
+#endif
+            return Level::Scalar;
+        }();
+
+        return level;
+    }
+
+    inline Level &_cap() {
+        static Level cap = Level::AVX512;
+        return cap;
+    }
+
+    // Instruction set in use: the detected one, capped by set_level.
+    inline Level level() {
+        return std::min(detected(), _cap());
+    }
+
+    // Caps the instruction set used by the kernels, e.g. to compare paths.
+    inline void set_level(Level cap) {
+        _cap() = cap;
+    }
+
+    // Kernel bodies, written once over a Bytes wide vector and inlined into each
+    // instruction set entry point below. Vectors go through memcpy so loads and
+    // stores stay unaligned-safe and alias-safe.
+    template<typename T, uint64_t Bytes>
+    struct _Kernel {
+        static constexpr uint64_t W = Bytes / sizeof(T);
+        typedef T V __attribute__((vector_size(Bytes)));
+        // Integer vectors of W lanes, for the 16-bit float conversions (T = float)
+        // and the int8 dot (T = int16_t). The element types are spelled through T
+        // so that GCC keeps them dependent vector types.
+        typedef std::conditional_t<true, uint16_t, T> H16 __attribute__((vector_size(2 * W)));
+        typedef std::conditional_t<true, uint32_t, T> U __attribute__((vector_size(4 * W)));
+        typedef std::conditional_t<true, int8_t, T> S8 __attribute__((vector_size(W)));
+        typedef std::conditional_t<true, int32_t, T> S32 __attribute__((vector_size(4 * W)));
+
+        __attribute__((always_inline)) static inline T dot(uint64_t n, const T *x, const T *y) {
+            V s0 = {}, s1 = {}, a, b, c, d;
+            uint64_t i = 0;
+            for (; i + 2 * W <= n; i += 2 * W) {
+                __builtin_memcpy(&a, x + i, Bytes);
+                __builtin_memcpy(&b, y + i, Bytes);
+                __builtin_memcpy(&c, x + i + W, Bytes);
+                __builtin_memcpy(&d, y + i + W, Bytes);
+                s0 += a * b;
+                s1 += c * d;
+            }
+            for (; i + W <= n; i += W) {
+                __builtin_memcpy(&a, x + i, Bytes);
+                __builtin_memcpy(&b, y + i, Bytes);
+                s0 += a * b;
+            }
+            s0 += s1;
+
+            T result = 0;
+            for (uint64_t k = 0; k < W; k++)
+                result += s0[k];
+            for (; i < n; i++)
+                result += x[i] * y[i];
+
+            return result;
+        }
+
+        __attribute__((always_inline)) static inline void axpy(uint64_t n, T alpha, const T *x, T *y) {
+            V a, b;
+            uint64_t i = 0;
+            for (; i + W <= n; i += W) {
+                __builtin_memcpy(&a, x + i, Bytes);
+                __builtin_memcpy(&b, y + i, Bytes);
+                b += alpha * a;
+                __builtin_memcpy(y + i, &b, Bytes);
+            }
+            for (; i < n; i++)
+                y[i] += alpha * x[i];
+        }
+
+        __attribute__((always_inline)) static inline void scal(uint64_t n, T alpha, T *x) {
+            V a;
+            uint64_t i = 0;
+            for (; i + W <= n; i += W) {
+                __builtin_memcpy(&a, x + i, Bytes);
+                a *= alpha;
+                __builtin_memcpy(x + i, &a, Bytes);
+            }
+            for (; i < n; i++)
+                x[i] *= alpha;
+        }
+
+        // sums = {x . y, x . x, y . y}, from a single pass over x and y.
+        __attribute__((always_inline)) static inline void dot_norms(uint64_t n, const T *x, const T *y, T *sums) {
+            V xy = {}, xx = {}, yy = {}, a, b;
+            uint64_t i = 0;
+            for (; i + W <= n; i += W) {
+                __builtin_memcpy(&a, x + i, Bytes);
+                __builtin_memcpy(&b, y + i, Bytes);
+                xy += a * b;
+                xx += a * a;
+                yy += b * b;
+            }
+
+            sums[0] = sums[1] = sums[2] = 0;
+            for (uint64_t k = 0; k < W; k++) {
+                sums[0] += xy[k];
+                sums[1] += xx[k];
+                sums[2] += yy[k];
+            }
+            for (; i < n; i++) {
+                sums[0] += x[i] * y[i];
+                sums[1] += x[i] * x[i];
+                sums[2] += y[i] * y[i];
+            }
+        }
+
+        __attribute__((always_inline)) static inline void axpby(uint64_t n, T alpha, const T *x, T beta, T *y) {
+            V a, b;
+            uint64_t i = 0;
+            for (; i + W <= n; i += W) {
+                __builtin_memcpy(&a, x + i, Bytes);
+                __builtin_memcpy(&b, y + i, Bytes);
+                b = alpha * a + beta * b;
+                __builtin_memcpy(y + i, &b, Bytes);
+            }
+            for (; i < n; i++)
+                y[i] = alpha * x[i] + beta * y[i];
+        }
+
+        // Loads W 16-bit floats from h and widens them into out: the bit
+        // manipulations of bf16/fp16's float conversion, on a whole vector at once.
+        template<typename H>
+        __attribute__((always_inline)) static inline void _widen(const H *h, V &out) {
+            if constexpr (W == 1)
+                out[0] = float(*h);
+            else {
+                H16 raw;
+                __builtin_memcpy(&raw, h, Bytes / 2);
+                const U w = __builtin_convertvector(raw, U) << 16;
+                if constexpr (std::is_same_v<H, bf16>)
+                    out = (V) w;
+                else {
+                    const U sign = w & 0x80000000u, two_w = w + w;
+                    const V normal = (V) ((two_w >> 4) + (0xE0u << 23)) * 0x1.0p-112f;
+                    const V subnormal = (V) ((two_w >> 17) | (126u << 23)) - 0.5f;
+                    out = (V) (sign | (two_w < (1u << 27) ? (U) subnormal : (U) normal));
+                }
+            }
+        }
+
+        // out[i] = float(x[i]) for 16-bit x.
+        template<typename H>
+        __attribute__((always_inline)) static inline void widen(uint64_t n, const H *x, T *out) {
+            V a;
+            uint64_t i = 0;
+            for (; i + W <= n; i += W) {
+                _widen(x + i, a);
+                __builtin_memcpy(out + i, &a, Bytes);
+            }
+            for (; i < n; i++)
+                out[i] = float(x[i]);
+        }
+
+        // Sum of x[i] * y[i] for 16-bit x, accumulated in float.
+        template<typename H>
+        __attribute__((always_inline)) static inline T widen_dot(uint64_t n, const H *x, const T *y) {
+            V s0 = {}, s1 = {}, a, b, c, d;
+            uint64_t i = 0;
+            for (; i + 2 * W <= n; i += 2 * W) {
+                _widen(x + i, a);
+                __builtin_memcpy(&b, y + i, Bytes);
+                _widen(x + i + W, c);
+                __builtin_memcpy(&d, y + i + W, Bytes);
+                s0 += a * b;
+                s1 += c * d;
+            }
+            for (; i + W <= n; i += W) {
+                _widen(x + i, a);
+                __builtin_memcpy(&b, y + i, Bytes);
+                s0 += a * b;
+            }
+            s0 += s1;
+
+            T result = 0;
+            for (uint64_t k = 0; k < W; k++)
+                result += s0[k];
+            for (; i < n; i++)
+                result += float(x[i]) * y[i];
+
+            return result;
+        }
+
+        // Sum of x[i] * y[i] over int8 values, accumulated in int32. Lanes are
+        // sign-extended to 16 bits, where every product fits (|x y| <= 2^14), and
+        // the products are widened once before the accumulation.
+        __attribute__((always_inline)) static inline int32_t dot_i8(uint64_t n, const int8_t *x, const int8_t *y) {
+            S8 a, b;
+            S32 s = {};
+            uint64_t i = 0;
+            for (; i + W <= n; i += W) {
+                __builtin_memcpy(&a, x + i, W);
+                __builtin_memcpy(&b, y + i, W);
+                s += __builtin_convertvector(__builtin_convertvector(a, V) * __builtin_convertvector(b, V), S32);
+            }
+
+            int32_t result = 0;
+            for (uint64_t k = 0; k < W; k++)
+                result += s[k];
+            for (; i < n; i++)
+                result += int32_t(x[i]) * int32_t(y[i]);
+
+            return result;
+        }
+
+        // y = A x for a row-major m x n A with leading dimension lda.
+        __attribute__((always_inline)) static inline void gemv(uint64_t m, uint64_t n, const T *A, uint64_t lda,
+                                                               const T *x, T *y) {
+            for (uint64_t i = 0; i < m; i++)
+                y[i] = dot(n, A + i * lda, x);
+        }
+
+        // C = A B for small row-major operands (A is m x p, B is p x n), without any
+        // packing: blocks of four rows times one vector of columns are accumulated in
+        // registers over the whole depth, so no partial sums go through memory.
+        __attribute__((always_inline)) static inline void gemm_small(uint64_t m, uint64_t n, uint64_t p,
+                                                                     const T *A, uint64_t lda, const T *B,
+                                                                     uint64_t ldb, T *C, uint64_t ldc) {
+            V b, c0, c1, c2, c3;
+            uint64_t j = 0;
+            for (; j + W <= n; j += W) {
+                uint64_t i = 0;
+                for (; i + 4 <= m; i += 4) {
+                    const T *a = A + i * lda;
+                    c0 = c1 = c2 = c3 = V{};
+                    for (uint64_t k = 0; k < p; k++) {
+                        __builtin_memcpy(&b, B + k * ldb + j, Bytes);
+                        c0 += a[k] * b;
+                        c1 += a[lda + k] * b;
+                        c2 += a[2 * lda + k] * b;
+                        c3 += a[3 * lda + k] * b;
+                    }
+                    __builtin_memcpy(C + i * ldc + j, &c0, Bytes);
+                    __builtin_memcpy(C + (i + 1) * ldc + j, &c1, Bytes);
+                    __builtin_memcpy(C + (i + 2) * ldc + j, &c2, Bytes);
+                    __builtin_memcpy(C + (i + 3) * ldc + j, &c3, Bytes);
+                }
+                for (; i < m; i++) {
+                    c0 = V{};
+                    for (uint64_t k = 0; k < p; k++) {
+                        __builtin_memcpy(&b, B + k * ldb + j, Bytes);
+                        c0 += A[i * lda + k] * b;
+                    }
+                    __builtin_memcpy(C + i * ldc + j, &c0, Bytes);
+                }
+            }
+
+            for (; j < n; j++)
+                for (uint64_t i = 0; i < m; i++) {
+                    T sum = 0;
+                    for (uint64_t k = 0; k < p; k++)
+                        sum += A[i * lda + k] * B[k * ldb + j];
+                    C[i * ldc + j] = sum;
+                }
+        }
+
+        // out = x (op) y, elementwise. Op is 0 for +, 1 for - and 2 for *.
+        template<int Op>
+        __attribute__((always_inline)) static inline void elementwise(uint64_t n, const T *x, const T *y, T *out) {
+            V a, b;
+            uint64_t i = 0;
+            for (; i + W <= n; i += W) {
+                __builtin_memcpy(&a, x + i, Bytes);
+                __builtin_memcpy(&b, y + i, Bytes);
+                if constexpr (Op == 0) a += b;
+                else if constexpr (Op == 1) a -= b;
+                else a *= b;
+                __builtin_memcpy(out + i, &a, Bytes);
+            }
+            for (; i < n; i++) {
+                if constexpr (Op == 0) out[i] = x[i] + y[i];
+                else if constexpr (Op == 1) out[i] = x[i] - y[i];
+                else out[i] = x[i] * y[i];
+            }
+        }
+
+        // GEMM microkernel: tile = sum over k of a_k b_k^T, where a holds kc packed
+        // columns of MR values and b holds kc packed rows of NR = 2 * W values.
+        // The MR x NR tile stays in registers and is written out row-major.
+        template<uint64_t MR>
+        __attribute__((always_inline)) static inline void gemm(uint64_t kc, const T *a, const T *b, T *tile) {
+            V c0[MR] = {}, c1[MR] = {}, b0, b1;
+            for (uint64_t k = 0; k < kc; k++, a += MR, b += 2 * W) {
+                __builtin_memcpy(&b0, b, Bytes);
+                __builtin_memcpy(&b1, b + W, Bytes);
+#pragma GCC unroll 16
+                for (uint64_t r = 0; r < MR; r++) {
+                    c0[r] += a[r] * b0;
+                    c1[r] += a[r] * b1;
+                }
+            }
+
+            for (uint64_t r = 0; r < MR; r++) {
+                __builtin_memcpy(tile + 2 * W * r, &c0[r], Bytes);
+                __builtin_memcpy(tile + 2 * W * r + W, &c1[r], Bytes);
+            }
+        }
+    };
+
+    // One entry point per instruction set; the target attribute lets the compiler
+    // emit that set's instructions for the inlined kernel body.
+#define MINILA_SIMD_ENTRY_POINTS(NAME, BYTES, MR, ...)                                                      \
+    struct NAME {                                                                                           \
+        static constexpr uint64_t gemm_mr = MR;                                                             \
+        template<typename T> static constexpr uint64_t vector_bytes = BYTES;                                \
+        template<typename T> static constexpr uint64_t gemm_nr = 2 * vector_bytes<T> / sizeof(T);           \
+        template<typename T> __VA_ARGS__ static T dot(uint64_t n, const T *x, const T *y) {                 \
+            return _Kernel<T, BYTES>::dot(n, x, y);                                                         \
+        }                                                                                                   \
+        template<typename T> __VA_ARGS__ static void axpy(uint64_t n, T alpha, const T *x, T *y) {          \
+            _Kernel<T, BYTES>::axpy(n, alpha, x, y);                                                        \
+        }                                                                                                   \
+        template<typename T> __VA_ARGS__ static void scal(uint64_t n, T alpha, T *x) {                      \
+            _Kernel<T, BYTES>::scal(n, alpha, x);                                                           \
+        }                                                                                                   \
+        template<typename T> __VA_ARGS__ static void dot_norms(uint64_t n, const T *x, const T *y,          \
+                                                               T *sums) {                                   \
+            _Kernel<T, BYTES>::dot_norms(n, x, y, sums);                                                    \
+        }                                                                                                   \
+        template<typename T> __VA_ARGS__ static void axpby(uint64_t n, T alpha, const T *x, T beta, T *y) { \
+            _Kernel<T, BYTES>::axpby(n, alpha, x, beta, y);                                                 \
+        }                                                                                                   \
+        template<typename T> __VA_ARGS__ static void gemv(uint64_t m, uint64_t n, const T *A, uint64_t lda, \
+                                                          const T *x, T *y) {                               \
+            _Kernel<T, BYTES>::gemv(m, n, A, lda, x, y);                                                    \
+        }                                                                                                   \
+        template<int Op, typename T> __VA_ARGS__ static void elementwise(uint64_t n, const T *x,            \
+                                                                         const T *y, T *out) {              \
+            _Kernel<T, BYTES>::template elementwise<Op>(n, x, y, out);                                      \
+        }                                                                                                   \
+        template<typename T> __VA_ARGS__ static void gemm_small(uint64_t m, uint64_t n, uint64_t p,         \
+                                                                const T *A, uint64_t lda, const T *B,       \
+                                                                uint64_t ldb, T *C, uint64_t ldc) {         \
+            _Kernel<T, BYTES>::gemm_small(m, n, p, A, lda, B, ldb, C, ldc);                                 \
+        }                                                                                                   \
+        template<typename T> __VA_ARGS__ static void gemm(uint64_t kc, const T *a, const T *b, T *tile) {   \
+            _Kernel<T, BYTES>::template gemm<MR>(kc, a, b, tile);                                           \
+        }                                                                                                   \
+        template<typename H> __VA_ARGS__ static void widen(uint64_t n, const H *x, float *out) {            \
+            _Kernel<float, vector_bytes<float>>::widen(n, x, out);                                          \
+        }                                                                                                   \
+        template<typename H> __VA_ARGS__ static float widen_dot(uint64_t n, const H *x, const float *y) {   \
+            return _Kernel<float, vector_bytes<float>>::widen_dot(n, x, y);                                 \
+        }                                                                                                   \
+        __VA_ARGS__ static int32_t dot_i8(uint64_t n, const int8_t *x, const int8_t *y) {                   \
+            return _Kernel<int16_t, vector_bytes<int16_t>>::dot_i8(n, x, y);                                \
+        }                                                                                                   \
+    };
+
+    // The GEMM row count MR sizes the register tile to the register file: 2 * MR
+    // accumulators plus two B vectors must fit (16 registers up to AVX2, 32 for AVX-512).
+    MINILA_SIMD_ENTRY_POINTS(_Scalar, sizeof(T), 4)
+#ifdef MINILA_SIMD_X86
+    MINILA_SIMD_ENTRY_POINTS(_SSE, 16, 4, __attribute__((target("sse2"))))
+    MINILA_SIMD_ENTRY_POINTS(_AVX2, 32, 6, __attribute__((target("avx2,fma"))))
+    MINILA_SIMD_ENTRY_POINTS(_AVX512, 64, 12, __attribute__((target("avx512f"))))
+#endif
+
+#undef MINILA_SIMD_ENTRY_POINTS
+
+    // Calls f.template operator()<ISA>() with the entry points for level().
+    template<typename F>
+    inline auto _dispatch(F &&f) {
+#ifdef MINILA_SIMD_X86
+        switch (level()) {
+            case Level::AVX512:
+                return f.template operator()<_AVX512>();
+            case Level::AVX2:
+                return f.template operator()<_AVX2>();
+            case Level::SSE:
+                return f.template operator()<_SSE>();
+            default:
+                break;
+        }
+#endif
+        return f.template operator()<_Scalar>();
+    }
+
+    template<typename T>
+    concept IsKernelType = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    // Sum of x[i] * y[i]
+    template<typename T>
+    requires IsKernelType<T>
+    T dot(uint64_t n, const T *x, const T *y) {
+        return _dispatch([&]<typename ISA>() { return ISA::template dot<T>(n, x, y); });
+    }
+
+    // y += alpha * x
+    template<typename T>
+    requires IsKernelType<T>
+    void axpy(uint64_t n, T alpha, const T *x, T *y) {
+        _dispatch([&]<typename ISA>() { ISA::template axpy<T>(n, alpha, x, y); });
+    }
+
+    // x *= alpha
+    template<typename T>
+    requires IsKernelType<T>
+    void scal(uint64_t n, T alpha, T *x) {
+        _dispatch([&]<typename ISA>() { ISA::template scal<T>(n, alpha, x); });
+    }
+
+    // sums = {x . y, x . x, y . y}, in one pass: a cosine for the memory traffic of a dot
+    template<typename T>
+    requires IsKernelType<T>
+    void dot_norms(uint64_t n, const T *x, const T *y, T *sums) {
+        _dispatch([&]<typename ISA>() { ISA::template dot_norms<T>(n, x, y, sums); });
+    }
+
+    // y = alpha * x + beta * y
+    template<typename T>
+    requires IsKernelType<T>
+    void axpby(uint64_t n, T alpha, const T *x, T beta, T *y) {
+        _dispatch([&]<typename ISA>() { ISA::template axpby<T>(n, alpha, x, beta, y); });
+    }
+
+    // y = A x, for a row-major m x n A with leading dimension lda
+    template<typename T>
+    requires IsKernelType<T>
+    void gemv(uint64_t m, uint64_t n, const T *A, uint64_t lda, const T *x, T *y) {
+        _dispatch([&]<typename ISA>() { ISA::template gemv<T>(m, n, A, lda, x, y); });
+    }
+
+    // out = x + y
+    template<typename T>
+    requires IsKernelType<T>
+    void add(uint64_t n, const T *x, const T *y, T *out) {
+        _dispatch([&]<typename ISA>() { ISA::template elementwise<0, T>(n, x, y, out); });
+    }
+
+    // out = x - y
+    template<typename T>
+    requires IsKernelType<T>
+    void subtract(uint64_t n, const T *x, const T *y, T *out) {
+        _dispatch([&]<typename ISA>() { ISA::template elementwise<1, T>(n, x, y, out); });
+    }
+
+    // out = x * y, elementwise
+    template<typename T>
+    requires IsKernelType<T>
+    void multiply(uint64_t n, const T *x, const T *y, T *out) {
+        _dispatch([&]<typename ISA>() { ISA::template elementwise<2, T>(n, x, y, out); });
+    }
+
+    // Sum of x[i] * y[i] for int8 x and y, accumulated in int32
+    inline int32_t dot(uint64_t n, const int8_t *x, const int8_t *y) {
+        return _dispatch([&]<typename ISA>() { return ISA::dot_i8(n, x, y); });
+    }
+
+    // out[i] = float(x[i]), for bf16 or fp16 x
+    template<typename H>
+    requires IsHalf<H>
+    void widen(uint64_t n, const H *x, float *out) {
+        _dispatch([&]<typename ISA>() { ISA::template widen<H>(n, x, out); });
+    }
+
+    // Sum of x[i] * y[i] for bf16 or fp16 x, accumulated in float
+    template<typename H>
+    requires IsHalf<H>
+    float dot(uint64_t n, const H *x, const float *y) {
+        return _dispatch([&]<typename ISA>() { return ISA::template widen_dot<H>(n, x, y); });
+    }
+
+};
+
+#endif //MINILA_SIMD_H
@@ -0,0 +1,362 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_SPARSE_H
+#define MINILA_SPARSE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "layout.h"
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace minila {
+
+    // Entry of a sparse matrix under construction; indices are 1-based.
+    template<typename T>
+    struct Triplet {
+        uint64_t row, col;
+        T value;
+    };
+
+    // Compressed sparse matrix. L picks the compressed axis: RowMajor is CSR
+    // (rows stored one after the other), ColMajor is CSC. Line k (a row for CSR,
+    // a column for CSC) holds entries offsets[k] to offsets[k + 1] - 1, sorted
+    // by their index along the other axis. Indices are 0-based internally.
+    template<typename T, Layout L = Layout::RowMajor>
+    class SparseMatrix {
+
+    public:
+        SparseMatrix() : _offsets(1), _rows(0), _cols(0) {}
+
+        // rows x cols matrix without entries.
+        SparseMatrix(uint64_t rows, uint64_t cols);
+
+        // Duplicated entries are summed.
+        SparseMatrix(uint64_t rows, uint64_t cols, const std::vector<Triplet<T>> &triplets);
+
+        // Keeps the non-zero entries of a dense matrix.
+        template<Layout LD>
+        explicit SparseMatrix(Matrix<T, 0, 0, LD> &dense);
+
+        // 1-based element read; zero for entries that are not stored.
+        T operator()(uint64_t row, uint64_t col);
+
+        Matrix<T, 0, 0, L> dense();
+
+        uint64_t rows();
+
+        uint64_t cols();
+
+        uint64_t nonzeros();
+
+        static constexpr Layout layout() { return L; }
+
+        // Number of compressed lines: rows for CSR, columns for CSC.
+        uint64_t lines();
+
+        // Raw compressed storage: lines() + 1 offsets, nonzeros() indices and values.
+        uint64_t *offsets();
+
+        uint64_t *indices();
+
+        T *values();
+
+    private:
+        Vector<uint64_t> _offsets, _indices;
+        Vector<T> _values;
+        uint64_t _rows, _cols;
+
+        void _build(std::vector<Triplet<T>> triplets);
+    };
+
+    template<typename T, Layout L>
+    SparseMatrix<T, L>::SparseMatrix(uint64_t rows, uint64_t cols) :
+            _offsets((L == Layout::RowMajor ? rows : cols) + 1), _rows(rows), _cols(cols) {}
+
+    template<typename T, Layout L>
+    SparseMatrix<T, L>::SparseMatrix(uint64_t rows, uint64_t cols, const std::vector<Triplet<T>> &triplets) :
+            SparseMatrix(rows, cols) {
+        for (auto &triplet: triplets)
+            if (triplet.row == 0 || triplet.row > rows || triplet.col == 0 || triplet.col > cols)
+                throw std::invalid_argument("Triplet out of bounds for SparseMatrix.");
+
+        _build(triplets);
+    }
+
+    template<typename T, Layout L>
+    template<Layout LD>
+    SparseMatrix<T, L>::SparseMatrix(Matrix<T, 0, 0, LD> &dense) : SparseMatrix(dense.rows(), dense.cols()) {
+        std::vector<Triplet<T>> triplets;
+        for (uint64_t i = 1; i <= _rows; i++)
+            for (uint64_t j = 1; j <= _cols; j++)
+                if (auto value = dense.at_unchecked(i, j); value != T(0))
+                    triplets.push_back({i, j, value});
+
+        _build(std::move(triplets));
+    }
+
+    // Counting sort of the entries by line, then by index within each line.
+    template<typename T, Layout L>
+    void SparseMatrix<T, L>::_build(std::vector<Triplet<T>> triplets) {
+        auto line = [](const Triplet<T> &t) { return (L == Layout::RowMajor ? t.row : t.col) - 1; };
+        auto index = [](const Triplet<T> &t) { return (L == Layout::RowMajor ? t.col : t.row) - 1; };
+
+        std::vector<uint64_t> start(lines() + 1, 0);
+        for (auto &triplet: triplets)
+            start[line(triplet) + 1]++;
+        std::partial_sum(start.begin(), start.end(), start.begin());
+
+        std::vector<Triplet<T>> sorted(triplets.size());
+        auto next = start;
+        for (auto &triplet: triplets)
+            sorted[next[line(triplet)]++] = triplet;
+
+        // Sorts each line and merges duplicates, compacting in place.
+        uint64_t count = 0;
+        for (uint64_t k = 0; k < lines(); k++) {
+            std::sort(sorted.begin() + start[k], sorted.begin() + start[k + 1],
+                      [&](auto &a, auto &b) { return index(a) < index(b); });
+
+            _offsets.data()[k] = count;
+            for (uint64_t e = start[k]; e < start[k + 1]; e++)
+                if (count > _offsets.data()[k] && index(sorted[count - 1]) == index(sorted[e]))
+                    sorted[count - 1].value += sorted[e].value;
+                else
+                    sorted[count++] = sorted[e];
+        }
+        _offsets.data()[lines()] = count;
+
+        _indices = Vector<uint64_t>(count);
+        _values = Vector<T>(count);
+        for (uint64_t e = 0; e < count; e++) {
+            _indices.data()[e] = index(sorted[e]);
+            _values.data()[e] = sorted[e].value;
+        }
+    }
+
+    template<typename T, Layout L>
+    T SparseMatrix<T, L>::operator()(uint64_t row, uint64_t col) {
+        if (row == 0 || row > _rows || col == 0 || col > _cols)
+            throw std::invalid_argument("Axis size mismatch for operation.");
+
+        const uint64_t k = (L == Layout::RowMajor ? row : col) - 1, target = (L == Layout::RowMajor ? col : row) - 1;
+        auto first = indices() + offsets()[k], last = indices() + offsets()[k + 1];
+        auto found = std::lower_bound(first, last, target);
+
+        return found != last && *found == target ? values()[found - indices()] : T(0);
+    }
+
+    template<typename T, Layout L>
+    Matrix<T, 0, 0, L> SparseMatrix<T, L>::dense() {
+        auto result = Matrix<T, 0, 0, L>(_rows, _cols);
+        const uint64_t ld = L == Layout::RowMajor ? _cols : _rows;
+        for (uint64_t k = 0; k < lines(); k++)
+            for (uint64_t e = offsets()[k]; e < offsets()[k + 1]; e++)
+                result.data()[k * ld + indices()[e]] = values()[e];
+
+        return result;
+    }
+
+    template<typename T, Layout L>
+    uint64_t SparseMatrix<T, L>::rows() {
+        return _rows;
+    }
+
+    template<typename T, Layout L>
+    uint64_t SparseMatrix<T, L>::cols() {
+        return _cols;
+    }
+
+    template<typename T, Layout L>
+    uint64_t SparseMatrix<T, L>::nonzeros() {
+        return _values.dimensions();
+    }
+
+    template<typename T, Layout L>
+    uint64_t SparseMatrix<T, L>::lines() {
+        return L == Layout::RowMajor ? _rows : _cols;
+    }
+
+    template<typename T, Layout L>
+    uint64_t *SparseMatrix<T, L>::offsets() {
+        return _offsets.data();
+    }
+
+    template<typename T, Layout L>
+    uint64_t *SparseMatrix<T, L>::indices() {
+        return _indices.data();
+    }
+
+    template<typename T, Layout L>
+    T *SparseMatrix<T, L>::values() {
+        return _values.data();
+    }
+
+    // Conversion between CSR and CSC (a transpose of the compressed storage).
+    template<Layout To, typename T, Layout From>
+    SparseMatrix<T, To> to_layout(SparseMatrix<T, From> &S) {
+        if constexpr (To == From)
+            return S;
+        else {
+            std::vector<Triplet<T>> triplets;
+            triplets.reserve(S.nonzeros());
+            for (uint64_t k = 0; k < S.lines(); k++)
+                for (uint64_t e = S.offsets()[k]; e < S.offsets()[k + 1]; e++)
+                    if constexpr (From == Layout::RowMajor)
+                        triplets.push_back({k + 1, S.indices()[e] + 1, S.values()[e]});
+                    else
+                        triplets.push_back({S.indices()[e] + 1, k + 1, S.values()[e]});
+
+            return SparseMatrix<T, To>(S.rows(), S.cols(), triplets);
+        }
+    }
+
+};
+
+namespace minila::sparse {
+
+    // Products with one sparse operand, in O(nonzeros) work. Products whose
+    // output lines map to lines of the sparse operand (CSR * Vector, Vector *
+    // CSC, CSR * Matrix, Matrix * CSR/CSC) are split across the thread pool;
+    // the others scatter into shared output and run serially, so prefer CSR
+    // for S * x and CSC for x * S.
+
+    // Sum of values[e] * x[indices[e]] over one compressed line.
+    template<typename T>
+    inline T _gather(const uint64_t *indices, const T *values, uint64_t first, uint64_t last, const T *x) {
+        T sum = 0;
+        for (uint64_t e = first; e < last; e++)
+            sum += values[e] * x[indices[e]];
+
+        return sum;
+    }
+
+    // SparseMatrix * Vector
+    template<typename T, Layout L>
+    Vector<T> multiply(SparseMatrix<T, L> &S, Vector<T> &v) {
+        if (S.cols() != v.dimensions())
+            throw std::invalid_argument("Invalid axis sizes on operation sparse::multiply.");
+
+        Vector<T> result(S.rows());
+        auto offsets = S.offsets();
+        auto indices = S.indices();
+        auto values = S.values();
+
+        if constexpr (L == Layout::RowMajor) {
+            const uint64_t per_line = S.nonzeros() / std::max<uint64_t>(S.lines(), 1);
+            ThreadPool::global().parallel_for(S.rows(), ThreadPool::grain(per_line), [&](uint64_t begin, uint64_t end) {
+                for (uint64_t i = begin; i < end; i++)
+                    result.data()[i] = _gather(indices, values, offsets[i], offsets[i + 1], v.data());
+            });
+        } else
+            for (uint64_t j = 0; j < S.cols(); j++)
+                for (uint64_t e = offsets[j]; e < offsets[j + 1]; e++)
+                    result.data()[indices[e]] += values[e] * v.data()[j];
+
+        return result;
+    }
+
+    // Vector * SparseMatrix
+    template<typename T, Layout L>
+    Vector<T> multiply(Vector<T> &v, SparseMatrix<T, L> &S) {
+        if (v.dimensions() != S.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation sparse::multiply.");
+
+        Vector<T> result(S.cols());
+        auto offsets = S.offsets();
+        auto indices = S.indices();
+        auto values = S.values();
+
+        if constexpr (L == Layout::ColMajor) {
+            const uint64_t per_line = S.nonzeros() / std::max<uint64_t>(S.lines(), 1);
+            ThreadPool::global().parallel_for(S.cols(), ThreadPool::grain(per_line), [&](uint64_t begin, uint64_t end) {
+                for (uint64_t j = begin; j < end; j++)
+                    result.data()[j] = _gather(indices, values, offsets[j], offsets[j + 1], v.data());
+            });
+        } else
+            for (uint64_t i = 0; i < S.rows(); i++)
+                for (uint64_t e = offsets[i]; e < offsets[i + 1]; e++)
+                    result.data()[indices[e]] += v.data()[i] * values[e];
+
+        return result;
+    }
+
+    // out += alpha * x over n contiguous elements.
+    template<typename T>
+    inline void _axpy(uint64_t n, T alpha, const T *x, T *out) {
+        if constexpr (simd::IsKernelType<T>)
+            simd::axpy<T>(n, alpha, x, out);
+        else
+            for (uint64_t j = 0; j < n; j++)
+                out[j] += alpha * x[j];
+    }
+
+    // SparseMatrix * Matrix: rows of the result are combinations of rows of M.
+    template<typename T, Layout L>
+    Matrix<T> multiply(SparseMatrix<T, L> &S, Matrix<T> &M) {
+        if (S.cols() != M.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation sparse::multiply.");
+
+        const uint64_t n = M.cols();
+        Matrix<T> result(S.rows(), n);
+        auto offsets = S.offsets();
+        auto indices = S.indices();
+        auto values = S.values();
+
+        if constexpr (L == Layout::RowMajor) {
+            const uint64_t per_line = S.nonzeros() / std::max<uint64_t>(S.lines(), 1);
+            const uint64_t grain = ThreadPool::grain(per_line * n);
+            ThreadPool::global().parallel_for(S.rows(), grain, [&](uint64_t begin, uint64_t end) {
+                for (uint64_t i = begin; i < end; i++)
+                    for (uint64_t e = offsets[i]; e < offsets[i + 1]; e++)
+                        _axpy(n, values[e], M.data() + indices[e] * n, result.data() + i * n);
+            });
+        } else
+            for (uint64_t k = 0; k < S.cols(); k++)
+                for (uint64_t e = offsets[k]; e < offsets[k + 1]; e++)
+                    _axpy(n, values[e], M.data() + k * n, result.data() + indices[e] * n);
+
+        return result;
+    }
+
+    // Matrix * SparseMatrix: row i of the result only depends on row i of M.
+    template<typename T, Layout L>
+    Matrix<T> multiply(Matrix<T> &M, SparseMatrix<T, L> &S) {
+        if (M.cols() != S.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation sparse::multiply.");
+
+        const uint64_t p = M.cols(), n = S.cols();
+        Matrix<T> result(M.rows(), n);
+        auto offsets = S.offsets();
+        auto indices = S.indices();
+        auto values = S.values();
+
+        ThreadPool::global().parallel_for(M.rows(), ThreadPool::grain(S.nonzeros()), [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) {
+                const T *row = M.data() + i * p;
+                T *out = result.data() + i * n;
+                if constexpr (L == Layout::RowMajor) {
+                    for (uint64_t k = 0; k < p; k++)
+                        for (uint64_t e = offsets[k]; e < offsets[k + 1]; e++)
+                            out[indices[e]] += row[k] * values[e];
+                } else
+                    for (uint64_t j = 0; j < n; j++)
+                        out[j] = _gather(indices, values, offsets[j], offsets[j + 1], row);
+            }
+        });
+
+        return result;
+    }
+
+};
+
+#endif //MINILA_SPARSE_H
@@ -0,0 +1,148 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_STRASSEN_H
+#define MINILA_STRASSEN_H
+
+#include <algorithm>
+#include <stdexcept>
+#include "blas_multiply.h"
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "vector.h"
+#include "view.h"
+
+namespace minila::strassen {
+
+    // Strassen-Winograd multiplication: 7 half-size products and 15 additions
+    // per level instead of 8 products, down to blocks no larger than a cutoff,
+    // which are handed to cblas_?gemm. Opt-in only: it trades accuracy for flops.
+    // Like plain gemm the error is normwise rather than componentwise; following
+    // Higham (Accuracy and Stability of Numerical Algorithms, sec. 23.2.2),
+    // for n x n operands, leaf size n0 and unit roundoff u,
+    //
+    //     max |C - fl(C)| <= [(n / n0)^log2(18) (n0^2 + 6 n0) - 6 n] u max|A| max|B| + O(u^2),
+    //
+    // against n^2 u max|A| max|B| for the plain product. Each level thus costs
+    // roughly a factor 18/4 = 4.5 in the bound, where gemm loses only 2.
+    constexpr uint64_t MINILA_STRASSEN_CUTOFF = 2048; // Largest side multiplied directly.
+
+    // out = x + sign * y, over views of one shape; out may alias x or y.
+    template<typename T>
+    void _add(MatrixView<T> x, MatrixView<T> y, MatrixView<T> out, T sign) {
+        const uint64_t cols = out.cols(), grain = ThreadPool::grain(cols);
+        ThreadPool::global().parallel_for(out.rows(), grain, [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) {
+                const T *a = x.data() + i * x.row_stride(), *b = y.data() + i * y.row_stride();
+                T *c = out.data() + i * out.row_stride();
+                if (x.col_stride() == 1 && y.col_stride() == 1 && out.col_stride() == 1)
+                    for (uint64_t j = 0; j < cols; j++)
+                        c[j] = a[j] + sign * b[j];
+                else
+                    for (uint64_t j = 0; j < cols; j++)
+                        c[j * out.col_stride()] = a[j * x.col_stride()] + sign * b[j * y.col_stride()];
+            }
+        });
+    }
+
+    // Elements of workspace needed by _multiply for an m x p by p x n product:
+    // three half-size temporaries per level, one level at a time.
+    inline uint64_t _workspace(uint64_t m, uint64_t p, uint64_t n, uint64_t cutoff) {
+        if (std::min({m, p, n}) <= std::max<uint64_t>(cutoff, 1))
+            return 0;
+
+        m /= 2, p /= 2, n /= 2;
+        return m * p + p * n + m * n + _workspace(m, p, n, cutoff);
+    }
+
+    // C = A B, with odd rows and columns peeled off and fixed up with gemm.
+    template<typename T>
+    void _multiply(MatrixView<T> A, MatrixView<T> B, MatrixView<T> C, T *workspace, uint64_t cutoff) {
+        const uint64_t m = A.rows(), p = A.cols(), n = B.cols();
+        if (std::min({m, p, n}) <= std::max<uint64_t>(cutoff, 1)) {
+            blas::_gemm(T(1), A, B, T(0), C);
+            return;
+        }
+
+        const uint64_t mh = m / 2, ph = p / 2, nh = n / 2;
+        auto A11 = A.block(1, 1, mh, ph), A12 = A.block(1, ph + 1, mh, ph);
+        auto A21 = A.block(mh + 1, 1, mh, ph), A22 = A.block(mh + 1, ph + 1, mh, ph);
+        auto B11 = B.block(1, 1, ph, nh), B12 = B.block(1, nh + 1, ph, nh);
+        auto B21 = B.block(ph + 1, 1, ph, nh), B22 = B.block(ph + 1, nh + 1, ph, nh);
+        auto C11 = C.block(1, 1, mh, nh), C12 = C.block(1, nh + 1, mh, nh);
+        auto C21 = C.block(mh + 1, 1, mh, nh), C22 = C.block(mh + 1, nh + 1, mh, nh);
+
+        // Temporaries for the sums of A blocks (X), of B blocks (Y) and for one
+        // product (Z); the quadrants of C hold the other products.
+        auto X = MatrixView<T>(workspace, mh, ph, ph, 1);
+        auto Y = MatrixView<T>(workspace + mh * ph, ph, nh, nh, 1);
+        auto Z = MatrixView<T>(workspace + mh * ph + ph * nh, mh, nh, nh, 1);
+        T *next = workspace + mh * ph + ph * nh + mh * nh;
+
+        _add(A11, A21, X, T(-1));                // S3 = A11 - A21
+        _add(B22, B12, Y, T(-1));                // T3 = B22 - B12
+        _multiply(X, Y, C21, next, cutoff);      // P7 = S3 T3
+
+        _add(A21, A22, X, T(1));                 // S1 = A21 + A22
+        _add(B12, B11, Y, T(-1));                // T1 = B12 - B11
+        _multiply(X, Y, C22, next, cutoff);      // P5 = S1 T1
+
+        _add(X, A11, X, T(-1));                  // S2 = S1 - A11
+        _add(B22, Y, Y, T(-1));                  // T2 = B22 - T1
+        _multiply(X, Y, C12, next, cutoff);      // P6 = S2 T2
+
+        _add(A12, X, X, T(-1));                  // S4 = A12 - S2
+        _multiply(X, B22, C11, next, cutoff);    // P3 = S4 B22
+
+        _multiply(A11, B11, Z, next, cutoff);    // P1 = A11 B11
+
+        _add(C12, Z, C12, T(1));                 // U2 = P1 + P6
+        _add(C21, C12, C21, T(1));               // U3 = U2 + P7
+        _add(C12, C22, C12, T(1));               // U4 = U2 + P5
+        _add(C22, C21, C22, T(1));               // C22 = U3 + P5
+        _add(C12, C11, C12, T(1));               // C12 = U4 + P3
+
+        _add(Y, B21, Y, T(-1));                  // T4 = T2 - B21
+        _multiply(A22, Y, C11, next, cutoff);    // P4 = A22 T4
+        _add(C21, C11, C21, T(-1));              // C21 = U3 - P4
+
+        _multiply(A12, B21, C11, next, cutoff);  // P2 = A12 B21
+        _add(C11, Z, C11, T(1));                 // C11 = P1 + P2
+
+        // Dynamic peeling of an odd depth, column count and row count.
+        if (p % 2)
+            blas::_gemm(T(1), A.block(1, p, 2 * mh, 1), B.block(p, 1, 1, 2 * nh), T(1),
+                        C.block(1, 1, 2 * mh, 2 * nh));
+        if (n % 2)
+            blas::_gemm(T(1), A, B.block(1, n, p, 1), T(0), C.block(1, n, m, 1));
+        if (m % 2)
+            blas::_gemm(T(1), A.block(m, 1, 1, p), B.block(1, 1, p, 2 * nh), T(0), C.block(m, 1, 1, 2 * nh));
+    }
+
+    // Matrix * Matrix; the result is stored in the layout of left. Products with
+    // every side up to cutoff run as a single gemm. The workspace for the whole
+    // recursion is allocated once, from Allocator::current().
+    template<typename T, Layout L1, Layout L2>
+    requires simd::IsKernelType<T>
+    Matrix<T, 0, 0, L1> multiply(Matrix<T, 0, 0, L1> &left, Matrix<T, 0, 0, L2> &right,
+                                 uint64_t cutoff = MINILA_STRASSEN_CUTOFF) {
+        if (left.cols() != right.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation strassen::multiply.");
+
+        auto C = Matrix<T, 0, 0, L1>(left.rows(), right.cols());
+        if (C.rows() == 0 || C.cols() == 0 || left.cols() == 0)
+            return C;
+
+        Vector<T> workspace(_workspace(left.rows(), left.cols(), right.cols(), cutoff));
+        _multiply(left.view(), right.view(), C.view(), workspace.data(), cutoff);
+
+        return C;
+    }
+
+};
+
+#endif //MINILA_STRASSEN_H
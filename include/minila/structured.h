@@ -0,0 +1,545 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_STRUCTURED_H
+#define MINILA_STRUCTURED_H
+
+#include <algorithm>
+#include <cblas.h>
+#include <stdexcept>
+#include <type_traits>
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace minila {
+
+    // Structured square matrices: only the entries that can be non-zero (or,
+    // for symmetric ones, one copy of each pair) are stored, in the layouts the
+    // matching BLAS routines expect (row-major). Element access is 1-based and
+    // throws for entries outside the structure; dense() expands to a Matrix.
+
+    enum class Triangle {
+        Upper,
+        Lower
+    };
+
+    // Symmetric matrix, upper triangle packed row by row: n (n + 1) / 2 elements.
+    template<typename T>
+    class SymmetricMatrix {
+    public:
+        SymmetricMatrix() : _n(0) {}
+
+        explicit SymmetricMatrix(uint64_t n) : _data(n * (n + 1) / 2), _n(n) {}
+
+        // Reads the upper triangle of a square matrix.
+        template<Layout L>
+        explicit SymmetricMatrix(Matrix<T, 0, 0, L> &dense) : SymmetricMatrix(dense.rows()) {
+            if (dense.rows() != dense.cols())
+                throw std::invalid_argument("SymmetricMatrix requires a square matrix.");
+            for (uint64_t i = 1; i <= _n; i++)
+                for (uint64_t j = i; j <= _n; j++)
+                    (*this)(i, j) = dense.at_unchecked(i, j);
+        }
+
+        // (i, j) and (j, i) are the same element.
+        T &operator()(uint64_t row, uint64_t col) {
+            if (row == 0 || row > _n || col == 0 || col > _n)
+                throw std::invalid_argument("Axis size mismatch for operation.");
+            if (row > col)
+                std::swap(row, col);
+
+            return _data.data()[(row - 1) * _n - (row - 1) * (row - 2) / 2 + (col - row)];
+        }
+
+        Matrix<T> dense() {
+            Matrix<T> result(_n, _n);
+            for (uint64_t i = 1; i <= _n; i++)
+                for (uint64_t j = i; j <= _n; j++)
+                    result.at_unchecked(i, j) = result.at_unchecked(j, i) = (*this)(i, j);
+
+            return result;
+        }
+
+        uint64_t rows() { return _n; }
+
+        uint64_t cols() { return _n; }
+
+        T *data() { return _data.data(); }
+
+    private:
+        Vector<T> _data;
+        uint64_t _n;
+    };
+
+    // Upper or lower triangular matrix, optionally with an implicit unit diagonal
+    // (as in the L factor of an LU). Kept in full n x n storage, as ?trmm and
+    // ?trsm require; the other triangle is zero.
+    template<typename T>
+    class TriangularMatrix {
+    public:
+        TriangularMatrix() : _triangle(Triangle::Upper), _unit(false) {}
+
+        TriangularMatrix(uint64_t n, Triangle triangle, bool unit = false) :
+                _data(n, n), _triangle(triangle), _unit(unit) {}
+
+        // Reads one triangle of a square matrix (without the diagonal when unit).
+        template<Layout L>
+        TriangularMatrix(Matrix<T, 0, 0, L> &dense, Triangle triangle, bool unit = false) :
+                TriangularMatrix(dense.rows(), triangle, unit) {
+            if (dense.rows() != dense.cols())
+                throw std::invalid_argument("TriangularMatrix requires a square matrix.");
+            for (uint64_t i = 1; i <= rows(); i++)
+                for (uint64_t j = 1; j <= rows(); j++)
+                    if (_stored(i, j))
+                        _data.at_unchecked(i, j) = dense.at_unchecked(i, j);
+        }
+
+        T &operator()(uint64_t row, uint64_t col) {
+            if (row == 0 || row > rows() || col == 0 || col > rows() || !_stored(row, col))
+                throw std::invalid_argument("Element outside of TriangularMatrix.");
+
+            return _data.at_unchecked(row, col);
+        }
+
+        Matrix<T> dense() {
+            Matrix<T> result = _data;
+            if (_unit)
+                for (uint64_t i = 1; i <= rows(); i++)
+                    result.at_unchecked(i, i) = T(1);
+
+            return result;
+        }
+
+        uint64_t rows() { return _data.rows(); }
+
+        uint64_t cols() { return _data.cols(); }
+
+        Triangle triangle() { return _triangle; }
+
+        bool unit() { return _unit; }
+
+        T *data() { return _data.data(); }
+
+    private:
+        Matrix<T> _data;
+        Triangle _triangle;
+        bool _unit;
+
+        bool _stored(uint64_t row, uint64_t col) {
+            if (_unit && row == col)
+                return false;
+
+            return _triangle == Triangle::Upper ? row <= col : row >= col;
+        }
+    };
+
+    // General band matrix with lower and upper bandwidths kl and ku, in BLAS
+    // row-major band storage: row i holds A(i, i - kl) to A(i, i + ku).
+    template<typename T>
+    class BandMatrix {
+    public:
+        BandMatrix() : _n(0), _kl(0), _ku(0) {}
+
+        BandMatrix(uint64_t n, uint64_t kl, uint64_t ku) : _data(n * (kl + ku + 1)), _n(n), _kl(kl), _ku(ku) {}
+
+        // Reads the band of a square matrix.
+        template<Layout L>
+        BandMatrix(Matrix<T, 0, 0, L> &dense, uint64_t kl, uint64_t ku) : BandMatrix(dense.rows(), kl, ku) {
+            if (dense.rows() != dense.cols())
+                throw std::invalid_argument("BandMatrix requires a square matrix.");
+            for (uint64_t i = 1; i <= _n; i++)
+                for (uint64_t j = i > kl ? i - kl : 1; j <= std::min(_n, i + ku); j++)
+                    (*this)(i, j) = dense.at_unchecked(i, j);
+        }
+
+        T &operator()(uint64_t row, uint64_t col) {
+            if (row == 0 || row > _n || col == 0 || col > _n || row > col + _kl || col > row + _ku)
+                throw std::invalid_argument("Element outside of BandMatrix.");
+
+            return _data.data()[(row - 1) * leading_dimension() + _kl + col - row];
+        }
+
+        Matrix<T> dense() {
+            Matrix<T> result(_n, _n);
+            for (uint64_t i = 1; i <= _n; i++)
+                for (uint64_t j = i > _kl ? i - _kl : 1; j <= std::min(_n, i + _ku); j++)
+                    result.at_unchecked(i, j) = (*this)(i, j);
+
+            return result;
+        }
+
+        uint64_t rows() { return _n; }
+
+        uint64_t cols() { return _n; }
+
+        uint64_t lower() { return _kl; }
+
+        uint64_t upper() { return _ku; }
+
+        uint64_t leading_dimension() { return _kl + _ku + 1; }
+
+        T *data() { return _data.data(); }
+
+    private:
+        Vector<T> _data;
+        uint64_t _n, _kl, _ku;
+    };
+
+    // Symmetric band matrix with bandwidth k, upper band in BLAS row-major band
+    // storage: row i holds A(i, i) to A(i, i + k).
+    template<typename T>
+    class SymmetricBandMatrix {
+    public:
+        SymmetricBandMatrix() : _n(0), _k(0) {}
+
+        SymmetricBandMatrix(uint64_t n, uint64_t k) : _data(n * (k + 1)), _n(n), _k(k) {}
+
+        // Reads the upper band of a square matrix.
+        template<Layout L>
+        SymmetricBandMatrix(Matrix<T, 0, 0, L> &dense, uint64_t k) : SymmetricBandMatrix(dense.rows(), k) {
+            if (dense.rows() != dense.cols())
+                throw std::invalid_argument("SymmetricBandMatrix requires a square matrix.");
+            for (uint64_t i = 1; i <= _n; i++)
+                for (uint64_t j = i; j <= std::min(_n, i + k); j++)
+                    (*this)(i, j) = dense.at_unchecked(i, j);
+        }
+
+        // (i, j) and (j, i) are the same element.
+        T &operator()(uint64_t row, uint64_t col) {
+            if (row > col)
+                std::swap(row, col);
+            if (row == 0 || col > _n || col > row + _k)
+                throw std::invalid_argument("Element outside of SymmetricBandMatrix.");
+
+            return _data.data()[(row - 1) * leading_dimension() + col - row];
+        }
+
+        Matrix<T> dense() {
+            Matrix<T> result(_n, _n);
+            for (uint64_t i = 1; i <= _n; i++)
+                for (uint64_t j = i; j <= std::min(_n, i + _k); j++)
+                    result.at_unchecked(i, j) = result.at_unchecked(j, i) = (*this)(i, j);
+
+            return result;
+        }
+
+        uint64_t rows() { return _n; }
+
+        uint64_t cols() { return _n; }
+
+        uint64_t bandwidth() { return _k; }
+
+        uint64_t leading_dimension() { return _k + 1; }
+
+        T *data() { return _data.data(); }
+
+    private:
+        Vector<T> _data;
+        uint64_t _n, _k;
+    };
+
+    // Diagonal matrix; only the diagonal is stored.
+    template<typename T>
+    class DiagonalMatrix {
+    public:
+        DiagonalMatrix() = default;
+
+        explicit DiagonalMatrix(uint64_t n) : _diagonal(n) {}
+
+        explicit DiagonalMatrix(Vector<T> &diagonal) : _diagonal(diagonal) {}
+
+        T &operator()(uint64_t row, uint64_t col) {
+            if (row != col)
+                throw std::invalid_argument("Element outside of DiagonalMatrix.");
+
+            return _diagonal(row);
+        }
+
+        Matrix<T> dense() {
+            Matrix<T> result(rows(), rows());
+            for (uint64_t i = 1; i <= rows(); i++)
+                result.at_unchecked(i, i) = _diagonal.at_unchecked(i);
+
+            return result;
+        }
+
+        uint64_t rows() { return _diagonal.dimensions(); }
+
+        uint64_t cols() { return _diagonal.dimensions(); }
+
+        Vector<T> &diagonal() { return _diagonal; }
+
+        T *data() { return _diagonal.data(); }
+
+    private:
+        Vector<T> _diagonal;
+    };
+
+};
+
+namespace minila::structured {
+
+    // Products and solves with the structured types. Symmetric, triangular and
+    // band operands go to the matching BLAS routine (float and double only);
+    // diagonal ones are O(n) or O(n^2) scalings for any arithmetic type.
+
+    inline CBLAS_UPLO _uplo(Triangle triangle) {
+        return triangle == Triangle::Upper ? CblasUpper : CblasLower;
+    }
+
+    template<typename T>
+    void _check(uint64_t left, uint64_t right) {
+        if (left != right)
+            throw std::invalid_argument("Invalid axis sizes on operation structured::multiply.");
+        if constexpr (!simd::IsKernelType<T>)
+            throw std::runtime_error("Unsupported type for structured::multiply.");
+    }
+
+    // SymmetricMatrix * Vector, through ?spmv on the packed storage.
+    template<typename T>
+    Vector<T> multiply(SymmetricMatrix<T> &S, Vector<T> &v) {
+        _check<T>(S.cols(), v.dimensions());
+
+        Vector<T> result(S.rows());
+        if constexpr (std::is_same_v<T, float>)
+            cblas_sspmv(CblasRowMajor, CblasUpper, S.rows(), 1.0f, S.data(), v.data(), 1, 0.0f, result.data(), 1);
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_dspmv(CblasRowMajor, CblasUpper, S.rows(), 1.0, S.data(), v.data(), 1, 0.0, result.data(), 1);
+
+        return result;
+    }
+
+    // C = S M (side Left) or M S (side Right), through ?symm. There is no packed
+    // ?symm, so the upper triangle is unpacked into a temporary first.
+    template<typename T>
+    Matrix<T> _symm(CBLAS_SIDE side, SymmetricMatrix<T> &S, Matrix<T> &M) {
+        const uint64_t n = S.rows(), rows = M.rows(), cols = M.cols();
+        Matrix<T> full(n, n), result(rows, cols);
+        for (uint64_t i = 1; i <= n; i++)
+            for (uint64_t j = i; j <= n; j++)
+                full.at_unchecked(i, j) = S(i, j);
+
+        if constexpr (std::is_same_v<T, float>)
+            cblas_ssymm(CblasRowMajor, side, CblasUpper, rows, cols, 1.0f, full.data(), n, M.data(), cols, 0.0f,
+                        result.data(), cols);
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_dsymm(CblasRowMajor, side, CblasUpper, rows, cols, 1.0, full.data(), n, M.data(), cols, 0.0,
+                        result.data(), cols);
+
+        return result;
+    }
+
+    // SymmetricMatrix * Matrix
+    template<typename T>
+    Matrix<T> multiply(SymmetricMatrix<T> &S, Matrix<T> &M) {
+        _check<T>(S.cols(), M.rows());
+        return _symm(CblasLeft, S, M);
+    }
+
+    // Matrix * SymmetricMatrix
+    template<typename T>
+    Matrix<T> multiply(Matrix<T> &M, SymmetricMatrix<T> &S) {
+        _check<T>(M.cols(), S.rows());
+        return _symm(CblasRight, S, M);
+    }
+
+    // x <- op(A) x or op(A)^-1 x, in place, through ?trmv / ?trsv.
+    template<typename T>
+    void _trv(bool solve, TriangularMatrix<T> &A, T *x) {
+        const auto uplo = _uplo(A.triangle());
+        const auto diag = A.unit() ? CblasUnit : CblasNonUnit;
+        const int n = A.rows();
+
+        if constexpr (std::is_same_v<T, float>) {
+            if (solve)
+                cblas_strsv(CblasRowMajor, uplo, CblasNoTrans, diag, n, A.data(), std::max(n, 1), x, 1);
+            else
+                cblas_strmv(CblasRowMajor, uplo, CblasNoTrans, diag, n, A.data(), std::max(n, 1), x, 1);
+        } else if constexpr (std::is_same_v<T, double>) {
+            if (solve)
+                cblas_dtrsv(CblasRowMajor, uplo, CblasNoTrans, diag, n, A.data(), std::max(n, 1), x, 1);
+            else
+                cblas_dtrmv(CblasRowMajor, uplo, CblasNoTrans, diag, n, A.data(), std::max(n, 1), x, 1);
+        }
+    }
+
+    // B <- A B (side Left) or B A (side Right), or the same with A^-1, in place,
+    // through ?trmm / ?trsm.
+    template<typename T>
+    void _trm(bool solve, CBLAS_SIDE side, TriangularMatrix<T> &A, Matrix<T> &B) {
+        const auto uplo = _uplo(A.triangle());
+        const auto diag = A.unit() ? CblasUnit : CblasNonUnit;
+        const int n = A.rows(), ldb = std::max<int>(B.cols(), 1);
+
+        if constexpr (std::is_same_v<T, float>) {
+            if (solve)
+                cblas_strsm(CblasRowMajor, side, uplo, CblasNoTrans, diag, B.rows(), B.cols(), 1.0f, A.data(),
+                            std::max(n, 1), B.data(), ldb);
+            else
+                cblas_strmm(CblasRowMajor, side, uplo, CblasNoTrans, diag, B.rows(), B.cols(), 1.0f, A.data(),
+                            std::max(n, 1), B.data(), ldb);
+        } else if constexpr (std::is_same_v<T, double>) {
+            if (solve)
+                cblas_dtrsm(CblasRowMajor, side, uplo, CblasNoTrans, diag, B.rows(), B.cols(), 1.0, A.data(),
+                            std::max(n, 1), B.data(), ldb);
+            else
+                cblas_dtrmm(CblasRowMajor, side, uplo, CblasNoTrans, diag, B.rows(), B.cols(), 1.0, A.data(),
+                            std::max(n, 1), B.data(), ldb);
+        }
+    }
+
+    // TriangularMatrix * Vector
+    template<typename T>
+    Vector<T> multiply(TriangularMatrix<T> &A, Vector<T> &v) {
+        _check<T>(A.cols(), v.dimensions());
+
+        Vector<T> result = v;
+        _trv(false, A, result.data());
+        return result;
+    }
+
+    // TriangularMatrix * Matrix
+    template<typename T>
+    Matrix<T> multiply(TriangularMatrix<T> &A, Matrix<T> &M) {
+        _check<T>(A.cols(), M.rows());
+
+        Matrix<T> result = M;
+        _trm(false, CblasLeft, A, result);
+        return result;
+    }
+
+    // Matrix * TriangularMatrix
+    template<typename T>
+    Matrix<T> multiply(Matrix<T> &M, TriangularMatrix<T> &A) {
+        _check<T>(M.cols(), A.rows());
+
+        Matrix<T> result = M;
+        _trm(false, CblasRight, A, result);
+        return result;
+    }
+
+    // Solves A x = b by substitution. A singular A (a zero on a non-unit
+    // diagonal) gives infinities or NaNs, as in BLAS.
+    template<typename T>
+    Vector<T> solve(TriangularMatrix<T> &A, Vector<T> &b) {
+        _check<T>(A.rows(), b.dimensions());
+
+        Vector<T> x = b;
+        _trv(true, A, x.data());
+        return x;
+    }
+
+    // Solves A X = B for every column of B.
+    template<typename T>
+    Matrix<T> solve(TriangularMatrix<T> &A, Matrix<T> &B) {
+        _check<T>(A.rows(), B.rows());
+
+        Matrix<T> X = B;
+        _trm(true, CblasLeft, A, X);
+        return X;
+    }
+
+    // BandMatrix * Vector, through ?gbmv.
+    template<typename T>
+    Vector<T> multiply(BandMatrix<T> &A, Vector<T> &v) {
+        _check<T>(A.cols(), v.dimensions());
+
+        Vector<T> result(A.rows());
+        const int n = A.rows(), lda = A.leading_dimension();
+        if constexpr (std::is_same_v<T, float>)
+            cblas_sgbmv(CblasRowMajor, CblasNoTrans, n, n, A.lower(), A.upper(), 1.0f, A.data(), lda, v.data(), 1,
+                        0.0f, result.data(), 1);
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_dgbmv(CblasRowMajor, CblasNoTrans, n, n, A.lower(), A.upper(), 1.0, A.data(), lda, v.data(), 1,
+                        0.0, result.data(), 1);
+
+        return result;
+    }
+
+    // SymmetricBandMatrix * Vector, through ?sbmv.
+    template<typename T>
+    Vector<T> multiply(SymmetricBandMatrix<T> &A, Vector<T> &v) {
+        _check<T>(A.cols(), v.dimensions());
+
+        Vector<T> result(A.rows());
+        const int n = A.rows(), lda = A.leading_dimension();
+        if constexpr (std::is_same_v<T, float>)
+            cblas_ssbmv(CblasRowMajor, CblasUpper, n, A.bandwidth(), 1.0f, A.data(), lda, v.data(), 1, 0.0f,
+                        result.data(), 1);
+        else if constexpr (std::is_same_v<T, double>)
+            cblas_dsbmv(CblasRowMajor, CblasUpper, n, A.bandwidth(), 1.0, A.data(), lda, v.data(), 1, 0.0,
+                        result.data(), 1);
+
+        return result;
+    }
+
+    // DiagonalMatrix * Vector
+    template<typename T>
+    Vector<T> multiply(DiagonalMatrix<T> &D, Vector<T> &v) {
+        if (D.cols() != v.dimensions())
+            throw std::invalid_argument("Invalid axis sizes on operation structured::multiply.");
+
+        Vector<T> result(v.dimensions());
+        if constexpr (simd::IsKernelType<T>)
+            simd::multiply<T>(v.dimensions(), D.data(), v.data(), result.data());
+        else
+            for (uint64_t i = 0; i < v.dimensions(); i++)
+                result.data()[i] = D.data()[i] * v.data()[i];
+
+        return result;
+    }
+
+    // Vector * DiagonalMatrix
+    template<typename T>
+    Vector<T> multiply(Vector<T> &v, DiagonalMatrix<T> &D) {
+        return multiply(D, v);
+    }
+
+    // DiagonalMatrix * Matrix: scales row i by D(i, i).
+    template<typename T>
+    Matrix<T> multiply(DiagonalMatrix<T> &D, Matrix<T> &M) {
+        if (D.cols() != M.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation structured::multiply.");
+
+        Matrix<T> result = M;
+        const uint64_t n = M.cols();
+        ThreadPool::global().parallel_for(M.rows(), ThreadPool::grain(n), [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++)
+                if constexpr (simd::IsKernelType<T>)
+                    simd::scal<T>(n, D.data()[i], result.data() + i * n);
+                else
+                    for (uint64_t j = 0; j < n; j++)
+                        result.data()[i * n + j] *= D.data()[i];
+        });
+
+        return result;
+    }
+
+    // Matrix * DiagonalMatrix: scales column j by D(j, j).
+    template<typename T>
+    Matrix<T> multiply(Matrix<T> &M, DiagonalMatrix<T> &D) {
+        if (M.cols() != D.rows())
+            throw std::invalid_argument("Invalid axis sizes on operation structured::multiply.");
+
+        Matrix<T> result(M.rows(), M.cols());
+        const uint64_t n = M.cols();
+        ThreadPool::global().parallel_for(M.rows(), ThreadPool::grain(n), [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++)
+                if constexpr (simd::IsKernelType<T>)
+                    simd::multiply<T>(n, M.data() + i * n, D.data(), result.data() + i * n);
+                else
+                    for (uint64_t j = 0; j < n; j++)
+                        result.data()[i * n + j] = M.data()[i * n + j] * D.data()[j];
+        });
+
+        return result;
+    }
+
+};
+
+#endif //MINILA_STRUCTURED_H
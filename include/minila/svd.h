@@ -7,65 +7,127 @@
 #ifndef MINILA_SVD_H
 #define MINILA_SVD_H
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <type_traits>
 #include <lapacke.h>
 #include "constants.h"
+#include "layout.h"
 #include "matrix.h"
+#include "vector.h"
 
 namespace minila {
 
-    template<typename T>
+    template<typename T, Layout L = Layout::RowMajor>
     struct SVD {
-        Matrix<T> U; // MxM left singular matrix
-        Vector<T> s; // min(M,N) singular values
-        Matrix<T> V; // NxN right singular matrix
+        Matrix<T, 0, 0, L> U; // MxM left singular matrix (MxK when thin, empty for values only)
+        Vector<T> s; // K = min(M,N) singular values
+        Matrix<T, 0, 0, L> V; // NxN right singular matrix, transposed (V^T) as returned by ?gesvd (KxN when thin)
 
         int info = 0; // Return code for SVD function
     };
 
-    template<typename T>
-    SVD<T> svd(Matrix<T> &M) {
-        throw std::runtime_error("Unsupported type for SVD.");
-    }
-
-    template<>
-    SVD<float> svd(Matrix<float> &M) {
-        Matrix<float> U(M.rows(), M.rows());
-        Matrix<float> V(M.cols(), M.cols());
-        Vector<float> s(std::min(M.rows(), M.cols()));
+    // Singular vectors to compute: all of them (jobs 'A'), the leading min(M,N)
+    // only ('S', enough to rebuild M and the only sane choice for tall or wide
+    // matrices), or none ('N').
+    enum class SVDJob {
+        All,
+        Thin,
+        Values
+    };
 
-        //To be unmercifully destroyed.
-        Matrix<float> _temp(M);
+    // ?gesvd (QR iteration) or ?gesdd (divide and conquer, much faster when
+    // vectors are wanted, at the cost of an integer workspace).
+    enum class SVDDriver {
+        QR,
+        DivideAndConquer
+    };
 
-        // To be used by the C-interface, meh.
-        Vector<float> b(std::min(M.rows(), M.cols()));
+    struct SVDOptions {
+        SVDJob job = SVDJob::All;
+        SVDDriver driver = SVDDriver::QR;
+        bool in_place = false; // Factor M's own storage, destroying it, instead of a copy.
+    };
 
-        auto info = LAPACKE_sgesvd(LAPACK_COL_MAJOR, 'A', 'A', M.rows(), M.cols(), _temp.data(),
-                                   M.rows(), s.data(), U.data(), U.rows(), V.data(), V.rows(), b.data());
+    // LAPACK workspace, reusable across calls: its size is queried (lwork = -1)
+    // on each call, which costs no flops, and the storage only ever grows.
+    template<typename T>
+    struct SVDWorkspace {
+        Vector<T> work;
+        Vector<int> iwork;
+    };
 
-        return SVD<float>{U, s, V, info};
+    // Column-major matrices are handed to LAPACK as they are. Row-major ones go
+    // through the LAPACKE row-major interface, which transposes internally; use
+    // Layout::ColMajor (or to_layout) for large decompositions.
+    template<typename T, Layout L>
+    SVD<T, L> svd(Matrix<T, 0, 0, L> &M, SVDOptions options, SVDWorkspace<T> &workspace) {
+        if constexpr (!std::is_same_v<T, float> && !std::is_same_v<T, double>)
+            throw std::runtime_error("Unsupported type for SVD.");
+
+        const uint64_t m = M.rows(), n = M.cols(), k = std::min(m, n);
+        const char job = options.job == SVDJob::All ? 'A' : options.job == SVDJob::Thin ? 'S' : 'N';
+
+        Matrix<T, 0, 0, L> U, V;
+        if (options.job != SVDJob::Values) {
+            U = Matrix<T, 0, 0, L>(m, options.job == SVDJob::All ? m : k);
+            V = Matrix<T, 0, 0, L>(options.job == SVDJob::All ? n : k, n);
+        }
+        Vector<T> s(k);
+
+        //To be unmercifully destroyed, unless M itself may be.
+        Matrix<T, 0, 0, L> _temp;
+        if (!options.in_place)
+            _temp = M;
+        auto &A = options.in_place ? M : _temp;
+
+        auto layout = L == Layout::ColMajor ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR;
+        const bool dc = options.driver == SVDDriver::DivideAndConquer;
+        if (dc && workspace.iwork.dimensions() < 8 * k)
+            workspace.iwork = Vector<int>(8 * k);
+
+        // lwork = -1 only writes the optimal size to *work.
+        auto call = [&](T *work, int lwork) {
+            if constexpr (std::is_same_v<T, float>) {
+                if (dc)
+                    return LAPACKE_sgesdd_work(layout, job, m, n, A.data(), A.leading_dimension(), s.data(),
+                                               U.data(), U.leading_dimension(), V.data(), V.leading_dimension(),
+                                               work, lwork, workspace.iwork.data());
+                return LAPACKE_sgesvd_work(layout, job, job, m, n, A.data(), A.leading_dimension(), s.data(),
+                                           U.data(), U.leading_dimension(), V.data(), V.leading_dimension(), work,
+                                           lwork);
+            } else if constexpr (std::is_same_v<T, double>) {
+                if (dc)
+                    return LAPACKE_dgesdd_work(layout, job, m, n, A.data(), A.leading_dimension(), s.data(),
+                                               U.data(), U.leading_dimension(), V.data(), V.leading_dimension(),
+                                               work, lwork, workspace.iwork.data());
+                return LAPACKE_dgesvd_work(layout, job, job, m, n, A.data(), A.leading_dimension(), s.data(),
+                                           U.data(), U.leading_dimension(), V.data(), V.leading_dimension(), work,
+                                           lwork);
+            }
+            return 0;
+        };
+
+        T size = 0;
+        int info = call(&size, -1);
+        if (info == 0) {
+            if (workspace.work.dimensions() < uint64_t(size))
+                workspace.work = Vector<T>(uint64_t(size));
+            info = call(workspace.work.data(), std::max<int>(1, workspace.work.dimensions()));
+        }
+
+        return SVD<T, L>{std::move(U), std::move(s), std::move(V), info};
     }
 
-    template<>
-    SVD<double> svd(Matrix<double> &M) {
-        Matrix<double> U(M.rows(), M.rows());
-        Matrix<double> V(M.cols(), M.cols());
-        Vector<double> s(std::min(M.rows(), M.cols()));
-
-        //To be unmercifully destroyed.
-        Matrix<double> _temp(M);
-
-        // To be used by the C-interface, meh.
-        Vector<double> b(std::min(M.rows(), M.cols()));
-
-        auto info = LAPACKE_dgesvd(LAPACK_COL_MAJOR, 'A', 'A', M.rows(), M.cols(), _temp.data(),
-                                   M.rows(), s.data(), U.data(), U.rows(), V.data(), V.rows(), b.data());
-
-        return SVD<double>{U, s, V, info};
+    template<typename T, Layout L>
+    SVD<T, L> svd(Matrix<T, 0, 0, L> &M, SVDOptions options = {}) {
+        SVDWorkspace<T> workspace;
+        return svd(M, options, workspace);
     }
 
-    template<typename T>
-    inline uint64_t rank(SVD<T> &S) {
+    template<typename T, Layout L>
+    inline uint64_t rank(SVD<T, L> &S) {
         uint64_t r = 0;
         for (auto i = 1; i <= S.s.dimensions(); i++)
             if (std::fabs(S.s(i)) >= MINILA_SVD_RANK)
@@ -73,6 +135,16 @@ namespace minila {
 
         return r;
     }
+
+    // Numerical rank from the singular values alone (?gesdd, no vectors).
+    template<typename T, Layout L>
+    inline uint64_t rank(Matrix<T, 0, 0, L> &M) {
+        auto S = svd(M, SVDOptions{SVDJob::Values, SVDDriver::DivideAndConquer});
+        if (S.info != 0)
+            throw std::runtime_error("SVD did not converge in rank.");
+
+        return rank(S);
+    }
 };
 
 #endif //MINILA_SVD_H
@@ -0,0 +1,253 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_THREAD_POOL_H
+#define MINILA_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace minila {
+
+    constexpr uint64_t MINILA_PARALLEL_GRAIN = 1 << 15; // Minimum work (elements or flops) per parallel task.
+
+    // Work-stealing pool shared by the naive and blocked backends. Each worker owns
+    // a deque: it pops its own tasks from the back and steals from the front of the
+    // others' when it runs dry. Threads waiting on a parallel_for help run tasks,
+    // so nested calls from inside a task do not deadlock.
+    //
+    // Idle workers sleep on a condition variable, so they do not compete with
+    // OpenBLAS's threads while blas:: calls run. Parallel regions whose tasks call
+    // into BLAS should be wrapped in a blas::SerialScope, as batched::multiply's are.
+    class ThreadPool {
+    public:
+        // threads counts the calling thread, so threads - 1 workers are started.
+        explicit ThreadPool(uint64_t threads = default_threads()) {
+            threads = std::max<uint64_t>(threads, 1);
+            for (uint64_t i = 0; i + 1 < threads; i++)
+                _queues.push_back(std::make_unique<_Queue>());
+            for (uint64_t i = 0; i + 1 < threads; i++)
+                _workers.emplace_back([this, i] { _work(i); });
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _wake.notify_all();
+            for (auto &worker: _workers)
+                worker.join();
+        }
+
+        uint64_t threads() const { return _workers.size() + 1; }
+
+        // Items per parallel task when each item costs work operations, so that no
+        // task gets less than MINILA_PARALLEL_GRAIN; small problems end up with a
+        // single task and run serially on the calling thread.
+        static constexpr uint64_t grain(uint64_t work) {
+            return std::max<uint64_t>(1, MINILA_PARALLEL_GRAIN / std::max<uint64_t>(work, 1));
+        }
+
+        // Calls function(begin, end) over disjoint ranges covering [0, n), each of
+        // at least grain items, and returns once all of them are done. Runs inline
+        // when the work does not split. The first exception thrown is rethrown.
+        template<typename F>
+        void parallel_for(uint64_t n, uint64_t grain, F &&function) {
+            const uint64_t chunks = _chunks(n, grain);
+            if (chunks <= 1) {
+                if (n > 0)
+                    function(uint64_t(0), n);
+                return;
+            }
+
+            const uint64_t step = (n + chunks - 1) / chunks;
+            std::atomic<uint64_t> remaining((n + step - 1) / step);
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            auto run = [&](uint64_t begin, uint64_t end) {
+                try {
+                    function(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                remaining--;
+            };
+
+            for (uint64_t begin = step; begin < n; begin += step)
+                _submit([&run, begin, end = std::min(n, begin + step)] { run(begin, end); });
+            run(0, std::min(n, step));
+
+            while (remaining > 0)
+                if (!_try_run())
+                    std::this_thread::yield();
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        // Sums function(begin, end) over the ranges of parallel_for. Partial results
+        // are added in range order, so the result only depends on the thread count.
+        template<typename T, typename F>
+        T parallel_reduce(uint64_t n, uint64_t grain, T init, F &&function) {
+            const uint64_t chunks = std::max<uint64_t>(_chunks(n, grain), 1);
+            const uint64_t step = (n + chunks - 1) / chunks;
+
+            std::vector<T> partial(chunks, T(0));
+            parallel_for(chunks, 1, [&](uint64_t first, uint64_t last) {
+                for (uint64_t c = first; c < last; c++)
+                    partial[c] = function(std::min(n, c * step), std::min(n, (c + 1) * step));
+            });
+
+            for (auto value: partial)
+                init += value;
+
+            return init;
+        }
+
+        // Pool used by the library. Sized from the MINILA_NUM_THREADS environment
+        // variable, or the hardware concurrency, the first time it is used.
+        static ThreadPool &global() {
+            return *_global();
+        }
+
+        // Replaces the global pool with one of the given size. Must not be called
+        // while parallel work is running.
+        static void configure(uint64_t threads) {
+            _global() = std::make_unique<ThreadPool>(threads);
+        }
+
+        static uint64_t default_threads() {
+            if (auto variable = std::getenv("MINILA_NUM_THREADS"))
+                if (auto threads = std::strtoull(variable, nullptr, 10); threads > 0)
+                    return threads;
+
+            return std::max<uint64_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        // True on the pool's worker threads.
+        static bool worker() { return _index() != nullptr; }
+
+    private:
+        struct _Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<_Queue>> _queues;
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::atomic<int64_t> _pending = 0; // Queued tasks; briefly negative while a push races a pop.
+        std::atomic<uint64_t> _next = 0;
+        bool _stop = false;
+
+        // Number of tasks n items are split into: enough for stealing to balance
+        // uneven tasks, but none smaller than grain.
+        uint64_t _chunks(uint64_t n, uint64_t grain) const {
+            if (_workers.empty())
+                return 1;
+
+            return std::min(4 * threads(), n / std::max<uint64_t>(grain, 1));
+        }
+
+        // Workers push onto their own deque, other threads spread tasks round-robin.
+        void _submit(std::function<void()> task) {
+            auto index = _index();
+            auto &queue = *_queues[index != nullptr && index->pool == this ? index->queue
+                                                                           : _next++ % _queues.size()];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            _pending++;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _wake.notify_one();
+        }
+
+        // Runs one task: the newest of the own deque, else the oldest of another.
+        bool _try_run() {
+            auto index = _index();
+            const bool own = index != nullptr && index->pool == this;
+            const uint64_t self = own ? index->queue : 0;
+
+            for (uint64_t i = 0; i < _queues.size(); i++) {
+                auto &queue = *_queues[(self + i) % _queues.size()];
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                if (queue.tasks.empty())
+                    continue;
+
+                std::function<void()> task;
+                if (own && i == 0) {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                } else {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+                _pending--;
+                lock.unlock();
+
+                task();
+                return true;
+            }
+
+            return false;
+        }
+
+        void _work(uint64_t queue) {
+            _Index index{this, queue};
+            _index() = &index;
+
+            while (true) {
+                if (_try_run())
+                    continue;
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this] { return _stop || _pending > 0; });
+                if (_stop && _pending <= 0)
+                    return;
+            }
+        }
+
+        struct _Index {
+            ThreadPool *pool;
+            uint64_t queue;
+        };
+
+        // Worker identity of the calling thread; nullptr outside the pool.
+        static _Index *&_index() {
+            thread_local _Index *index = nullptr;
+            return index;
+        }
+
+        static std::unique_ptr<ThreadPool> &_global() {
+            static std::unique_ptr<ThreadPool> pool = std::make_unique<ThreadPool>();
+            return pool;
+        }
+    };
+
+};
+
+#endif //MINILA_THREAD_POOL_H
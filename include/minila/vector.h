@@ -7,12 +7,19 @@
 #ifndef MINILA_VECTOR_H
 #define MINILA_VECTOR_H
 
+#include <utility>
 #include "base.h"
+#include "view.h"
 
 namespace minila {
 
+    // Vector<T> is heap backed and sized at runtime. Vector<T, N> has its size
+    // fixed at compile time and stores its elements inline (see fixed.h).
+    template<typename T, uint64_t N = 0>
+    class Vector;
+
     template<typename T>
-    class Vector {
+    class Vector<T, 0> {
 
     public:
         friend class Vector;
@@ -21,15 +28,43 @@ namespace minila {
 
         Vector(const Vector<T> &right);
 
+        Vector(Vector<T> &&right) noexcept;
+
         explicit Vector(BaseArray<T> &right);
 
+        explicit Vector(BaseArray<T> &&right);
+
+        // Materializes a view into a new, contiguous vector.
+        explicit Vector(VectorView<T> right);
+
         explicit Vector(uint64_t dimensions);
 
+        Vector<T> &operator=(const Vector<T> &right);
+
+        Vector<T> &operator=(Vector<T> &&right) noexcept;
+
+        // 1-based element access; bounds checked under MINILA_BOUNDS_CHECK.
         T &operator()(uint64_t dimension);
 
-        Vector<T> operator+(const Vector<T> &right);
+        // 1-based element access without any checks.
+        T &at_unchecked(uint64_t dimension);
 
-        Vector<T> operator-(const Vector<T> &right);
+        // Evaluates an elementwise expression (e.g. u + v - 2 * w) in a single pass.
+        template<typename E>
+        requires IsExpression<E>
+        Vector(const E &expression);
+
+        template<typename E>
+        requires IsExpression<E>
+        Vector<T> &operator=(const E &expression);
+
+        // Leaf node for elementwise expressions (see expression.h).
+        ArrayExpression<T> expression() const;
+
+        // Zero-copy views over this vector; valid while the vector is alive.
+        VectorView<T> view();
+
+        VectorView<T> segment(uint64_t start, uint64_t dimensions);
 
         uint64_t dimensions();
 
@@ -41,38 +76,96 @@ namespace minila {
     };
 
     template<typename T>
-    Vector<T>::Vector(const Vector<T> &right) {
-        _dimensions = right._dimensions;
-        _data = right._data;
+    Vector<T>::Vector(const Vector<T> &right) : _data(right._data), _dimensions(right._dimensions) {}
+
+    template<typename T>
+    Vector<T>::Vector(Vector<T> &&right) noexcept :
+            _data(std::move(right._data)), _dimensions(std::exchange(right._dimensions, 0)) {}
+
+    template<typename T>
+    Vector<T>::Vector(BaseArray<T> &right) : _data(right), _dimensions(right[0]) {}
+
+    template<typename T>
+    Vector<T>::Vector(BaseArray<T> &&right) : _dimensions(right[0]) {
+        _data = std::move(right);
     }
 
     template<typename T>
-    Vector<T>::Vector(BaseArray<T> &right) {
-        _dimensions = right[0];
-        _data = right;
+    Vector<T>::Vector(uint64_t dimensions) : _data({dimensions,}), _dimensions(dimensions) {}
+
+    template<typename T>
+    Vector<T> &Vector<T>::operator=(const Vector<T> &right) {
+        _data = right._data;
+        _dimensions = right._dimensions;
+
+        return *this;
     }
 
     template<typename T>
-    Vector<T>::Vector(uint64_t dimensions) {
-        _dimensions = dimensions;
-        _data = BaseArray<T>({dimensions,});
+    Vector<T> &Vector<T>::operator=(Vector<T> &&right) noexcept {
+        _data = std::move(right._data);
+        _dimensions = std::exchange(right._dimensions, 0);
+
+        return *this;
     }
 
     template<typename T>
     T &Vector<T>::operator()(uint64_t dimension) {
-        return _data({dimension - 1,});
+#ifdef MINILA_BOUNDS_CHECK
+        if (dimension == 0 || dimension > _dimensions)
+            throw std::invalid_argument("Axis size mismatch for operation.");
+#endif
+
+        return at_unchecked(dimension);
+    }
+
+    template<typename T>
+    inline T &Vector<T>::at_unchecked(uint64_t dimension) {
+        return _data.data()[dimension - 1];
+    }
+
+    template<typename T>
+    Vector<T>::Vector(VectorView<T> right) : Vector(right.dimensions()) {
+        for (uint64_t i = 1; i <= _dimensions; i++)
+            _data.data()[i - 1] = right(i);
+    }
+
+    template<typename T>
+    VectorView<T> Vector<T>::view() {
+        return VectorView<T>(_data);
     }
 
     template<typename T>
-    Vector<T> Vector<T>::operator+(const Vector<T> &right) {
-        BaseArray<T> result = _data + right._data;
-        return Vector<T>(result);
+    VectorView<T> Vector<T>::segment(uint64_t start, uint64_t dimensions) {
+        return view().segment(start, dimensions);
     }
 
     template<typename T>
-    Vector<T> Vector<T>::operator-(const Vector<T> &right) {
-        BaseArray<T> result = _data - right._data;
-        return Vector<T>(result);
+    template<typename E>
+    requires IsExpression<E>
+    Vector<T>::Vector(const E &expression) : _data(expression), _dimensions(0) {
+        if (_data.ndim() != 1)
+            throw std::invalid_argument("Vector requires a one dimensional expression.");
+
+        _dimensions = _data[0];
+    }
+
+    template<typename T>
+    template<typename E>
+    requires IsExpression<E>
+    Vector<T> &Vector<T>::operator=(const E &expression) {
+        if (expression.ndim() != 1)
+            throw std::invalid_argument("Vector requires a one dimensional expression.");
+
+        _data = expression;
+        _dimensions = _data[0];
+
+        return *this;
+    }
+
+    template<typename T>
+    ArrayExpression<T> Vector<T>::expression() const {
+        return _data.expression();
     }
 
     template<typename T>
@@ -85,6 +178,26 @@ namespace minila {
         return _data.data();
     }
 
+    // Explicit conversion between element types (see the Matrix to_type).
+    template<typename To, typename T>
+    Vector<To> to_type(Vector<T> &v) {
+        if constexpr (std::is_same_v<To, T>)
+            return v;
+        else {
+            auto result = Vector<To>(v.dimensions());
+            const uint64_t n = v.dimensions();
+            ThreadPool::global().parallel_for(n, ThreadPool::grain(1), [&](uint64_t begin, uint64_t end) {
+                if constexpr (IsHalf<T> && std::is_same_v<To, float>)
+                    simd::widen(end - begin, v.data() + begin, result.data() + begin);
+                else
+                    for (uint64_t i = begin; i < end; i++)
+                        result.data()[i] = static_cast<To>(v.data()[i]);
+            });
+
+            return result;
+        }
+    }
+
 };
 
 #endif //MINILA_VECTOR_H
@@ -0,0 +1,215 @@
+/*
+ * Please check README.md for copyright and licensing.
+ * If not available contact developer at vitor@bezzan.com
+ * Code is distributed as-is without any guarantee of purpose.
+ */
+
+#ifndef MINILA_VIEW_H
+#define MINILA_VIEW_H
+
+#include <cstdint>
+#include <stdexcept>
+#include "base.h"
+
+namespace minila {
+
+    // Non-owning views over existing storage. Views never allocate, and the
+    // memory they point to must outlive them. Indexing is 1-based, like Matrix
+    // and Vector.
+
+    template<typename T>
+    class VectorView {
+
+    public:
+        VectorView() : _data(nullptr), _dimensions(0), _stride(0) {}
+
+        VectorView(T *data, uint64_t dimensions, uint64_t stride = 1) :
+                _data(data), _dimensions(dimensions), _stride(stride) {}
+
+        explicit VectorView(BaseArray<T> &array);
+
+        T &operator()(uint64_t dimension);
+
+        // Contiguous run of elements, starting at (1-based) start.
+        VectorView<T> segment(uint64_t start, uint64_t dimensions);
+
+        uint64_t dimensions();
+
+        // Distance, in elements, between consecutive entries.
+        uint64_t stride();
+
+        T *data();
+
+    private:
+        T *_data;
+        uint64_t _dimensions;
+        uint64_t _stride;
+    };
+
+    template<typename T>
+    class MatrixView {
+
+    public:
+        MatrixView() : _data(nullptr), _rows(0), _cols(0), _row_stride(0), _col_stride(0) {}
+
+        MatrixView(T *data, uint64_t rows, uint64_t cols, uint64_t row_stride, uint64_t col_stride) :
+                _data(data), _rows(rows), _cols(cols), _row_stride(row_stride), _col_stride(col_stride) {}
+
+        explicit MatrixView(BaseArray<T> &array);
+
+        T &operator()(uint64_t row, uint64_t col);
+
+        VectorView<T> row(uint64_t row);
+
+        VectorView<T> col(uint64_t col);
+
+        // rows x cols sub-block whose top-left element is (row, col).
+        MatrixView<T> block(uint64_t row, uint64_t col, uint64_t rows, uint64_t cols);
+
+        // Lazy transpose: swaps shape and strides, no data is moved.
+        MatrixView<T> transpose();
+
+        uint64_t rows();
+
+        uint64_t cols();
+
+        uint64_t row_stride();
+
+        uint64_t col_stride();
+
+        // True when elements of a row are contiguous (row-major storage).
+        bool row_major();
+
+        // True when elements of a column are contiguous (column-major storage).
+        bool col_major();
+
+        T *data();
+
+    private:
+        T *_data;
+        uint64_t _rows, _cols;
+        uint64_t _row_stride, _col_stride;
+    };
+
+    template<typename T>
+    VectorView<T>::VectorView(BaseArray<T> &array) : VectorView() {
+        if (array.ndim() != 1)
+            throw std::invalid_argument("VectorView requires a one dimensional array.");
+
+        _data = array.data();
+        _dimensions = array[0];
+        _stride = 1;
+    }
+
+    template<typename T>
+    T &VectorView<T>::operator()(uint64_t dimension) {
+        return _data[(dimension - 1) * _stride];
+    }
+
+    template<typename T>
+    VectorView<T> VectorView<T>::segment(uint64_t start, uint64_t dimensions) {
+        if (start == 0 || start - 1 + dimensions > _dimensions)
+            throw std::invalid_argument("Segment out of bounds for VectorView.");
+
+        return VectorView<T>(_data + (start - 1) * _stride, dimensions, _stride);
+    }
+
+    template<typename T>
+    uint64_t VectorView<T>::dimensions() {
+        return _dimensions;
+    }
+
+    template<typename T>
+    uint64_t VectorView<T>::stride() {
+        return _stride;
+    }
+
+    template<typename T>
+    T *VectorView<T>::data() {
+        return _data;
+    }
+
+    template<typename T>
+    MatrixView<T>::MatrixView(BaseArray<T> &array) : MatrixView() {
+        if (array.ndim() != 2)
+            throw std::invalid_argument("MatrixView requires a two dimensional array.");
+
+        _data = array.data();
+        _rows = array[0];
+        _cols = array[1];
+        _row_stride = _cols;
+        _col_stride = 1;
+    }
+
+    template<typename T>
+    T &MatrixView<T>::operator()(uint64_t row, uint64_t col) {
+        return _data[(row - 1) * _row_stride + (col - 1) * _col_stride];
+    }
+
+    template<typename T>
+    VectorView<T> MatrixView<T>::row(uint64_t row) {
+        if (row == 0 || row > _rows)
+            throw std::invalid_argument("Row out of bounds for MatrixView.");
+
+        return VectorView<T>(_data + (row - 1) * _row_stride, _cols, _col_stride);
+    }
+
+    template<typename T>
+    VectorView<T> MatrixView<T>::col(uint64_t col) {
+        if (col == 0 || col > _cols)
+            throw std::invalid_argument("Column out of bounds for MatrixView.");
+
+        return VectorView<T>(_data + (col - 1) * _col_stride, _rows, _row_stride);
+    }
+
+    template<typename T>
+    MatrixView<T> MatrixView<T>::block(uint64_t row, uint64_t col, uint64_t rows, uint64_t cols) {
+        if (row == 0 || col == 0 || row - 1 + rows > _rows || col - 1 + cols > _cols)
+            throw std::invalid_argument("Block out of bounds for MatrixView.");
+
+        return MatrixView<T>(&(*this)(row, col), rows, cols, _row_stride, _col_stride);
+    }
+
+    template<typename T>
+    MatrixView<T> MatrixView<T>::transpose() {
+        return MatrixView<T>(_data, _cols, _rows, _col_stride, _row_stride);
+    }
+
+    template<typename T>
+    uint64_t MatrixView<T>::rows() {
+        return _rows;
+    }
+
+    template<typename T>
+    uint64_t MatrixView<T>::cols() {
+        return _cols;
+    }
+
+    template<typename T>
+    uint64_t MatrixView<T>::row_stride() {
+        return _row_stride;
+    }
+
+    template<typename T>
+    uint64_t MatrixView<T>::col_stride() {
+        return _col_stride;
+    }
+
+    template<typename T>
+    bool MatrixView<T>::row_major() {
+        return _col_stride == 1 && _row_stride >= _cols;
+    }
+
+    template<typename T>
+    bool MatrixView<T>::col_major() {
+        return _row_stride == 1 && _col_stride >= _rows;
+    }
+
+    template<typename T>
+    T *MatrixView<T>::data() {
+        return _data;
+    }
+
+};
+
+#endif //MINILA_VIEW_H
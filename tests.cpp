@@ -4,10 +4,797 @@
  * Code is distributed as-is without any guarantee of purpose.
  */
 
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
 #include <gtest/gtest.h>
 #include "include/minila/minila.h"
 
+using namespace minila;
+
+namespace {
+
+    // Absolute tolerance per unit of magnitude for sums of a few hundred terms.
+    template<typename T>
+    constexpr double tolerance() {
+        return std::is_same_v<T, double> ? 1e-10 : 1e-4;
+    }
+
+    template<typename T, Layout L = Layout::RowMajor>
+    Matrix<T, 0, 0, L> random_matrix(uint64_t rows, uint64_t cols, uint64_t seed) {
+        std::mt19937_64 generator(seed);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+
+        Matrix<T, 0, 0, L> result(rows, cols);
+        for (uint64_t i = 1; i <= rows; i++)
+            for (uint64_t j = 1; j <= cols; j++)
+                result(i, j) = T(uniform(generator));
+
+        return result;
+    }
+
+    template<typename T>
+    Vector<T> random_vector(uint64_t dimensions, uint64_t seed) {
+        std::mt19937_64 generator(seed);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+
+        Vector<T> result(dimensions);
+        for (uint64_t i = 1; i <= dimensions; i++)
+            result(i) = T(uniform(generator));
+
+        return result;
+    }
+
+    template<typename T>
+    double widen(T x) {
+        if constexpr (IsHalf<T>)
+            return float(x);
+        else
+            return double(x);
+    }
+
+    // A * B in double, straight from the definition.
+    template<typename A, typename B>
+    Matrix<double> reference(MatrixView<A> left, MatrixView<B> right) {
+        Matrix<double> result(left.rows(), right.cols());
+        for (uint64_t i = 1; i <= left.rows(); i++)
+            for (uint64_t j = 1; j <= right.cols(); j++) {
+                double sum = 0;
+                for (uint64_t k = 1; k <= left.cols(); k++)
+                    sum += widen(left(i, k)) * widen(right(k, j));
+                result(i, j) = sum;
+            }
+
+        return result;
+    }
+
+    template<typename T>
+    void expect_near(MatrixView<T> actual, MatrixView<double> expected, double tol) {
+        ASSERT_EQ(actual.rows(), expected.rows());
+        ASSERT_EQ(actual.cols(), expected.cols());
+        for (uint64_t i = 1; i <= actual.rows(); i++)
+            for (uint64_t j = 1; j <= actual.cols(); j++)
+                ASSERT_NEAR(widen(actual(i, j)), expected(i, j), tol * (1 + std::fabs(expected(i, j))))
+                                            << "at (" << i << ", " << j << ")";
+    }
+
+    template<typename T>
+    void expect_near(VectorView<T> actual, VectorView<double> expected, double tol) {
+        ASSERT_EQ(actual.dimensions(), expected.dimensions());
+        for (uint64_t i = 1; i <= actual.dimensions(); i++)
+            ASSERT_NEAR(widen(actual(i)), expected(i), tol * (1 + std::fabs(expected(i)))) << "at " << i;
+    }
+
+    // Runs every test of a suite once per instruction set this CPU supports, with
+    // the kernels capped to it through simd::set_level.
+    class SimdLevel : public testing::TestWithParam<simd::Level> {
+    protected:
+        void SetUp() override {
+            if (GetParam() > simd::detected())
+                GTEST_SKIP() << "Instruction set not supported by this CPU.";
+            simd::set_level(GetParam());
+        }
+
+        void TearDown() override {
+            simd::set_level(simd::Level::AVX512);
+        }
+    };
+
+    std::string level_name(const testing::TestParamInfo<simd::Level> &info) {
+        switch (info.param) {
+            case simd::Level::Scalar:
+                return "Scalar";
+            case simd::Level::SSE:
+                return "SSE";
+            case simd::Level::AVX2:
+                return "AVX2";
+            default:
+                return "AVX512";
+        }
+    }
+
+}
+
+// SIMD kernels, against plain loops; lengths cover empty input, pure tails and
+// several full vectors plus a tail for every width.
+
+TEST_P(SimdLevel, LevelOneKernels) {
+    for (uint64_t n: {0, 1, 3, 7, 17, 33, 100}) {
+        auto x = random_vector<float>(n, 1), y = random_vector<float>(n, 2);
+
+        double dot = 0, xx = 0, yy = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            dot += double(x.data()[i]) * y.data()[i];
+            xx += double(x.data()[i]) * x.data()[i];
+            yy += double(y.data()[i]) * y.data()[i];
+        }
+        EXPECT_NEAR(simd::dot(n, x.data(), y.data()), dot, 1e-4);
+
+        float sums[3];
+        simd::dot_norms(n, x.data(), y.data(), sums);
+        EXPECT_NEAR(sums[0], dot, 1e-4);
+        EXPECT_NEAR(sums[1], xx, 1e-4);
+        EXPECT_NEAR(sums[2], yy, 1e-4);
+
+        auto z = Vector<float>(y);
+        simd::axpby(n, 2.0f, x.data(), -0.5f, z.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_FLOAT_EQ(z.data()[i], 2.0f * x.data()[i] - 0.5f * y.data()[i]);
+
+        z = Vector<float>(y);
+        simd::axpy(n, 3.0f, x.data(), z.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_FLOAT_EQ(z.data()[i], y.data()[i] + 3.0f * x.data()[i]);
+
+        simd::scal(n, 0.25f, z.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_FLOAT_EQ(z.data()[i], 0.25f * (y.data()[i] + 3.0f * x.data()[i]));
+
+        simd::add(n, x.data(), y.data(), z.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_EQ(z.data()[i], x.data()[i] + y.data()[i]);
+
+        simd::subtract(n, x.data(), y.data(), z.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_EQ(z.data()[i], x.data()[i] - y.data()[i]);
+
+        simd::multiply(n, x.data(), y.data(), z.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_EQ(z.data()[i], x.data()[i] * y.data()[i]);
+    }
+}
+
+TEST_P(SimdLevel, GemvKernel) {
+    for (uint64_t m: {1, 5, 19})
+        for (uint64_t n: {1, 8, 31}) {
+            auto A = random_matrix<double>(m, n + 3, m * n);
+            auto x = random_vector<double>(n, 7);
+
+            Vector<double> y(m);
+            simd::gemv(m, n, A.data(), n + 3, x.data(), y.data());
+            for (uint64_t i = 1; i <= m; i++) {
+                double sum = 0;
+                for (uint64_t k = 1; k <= n; k++)
+                    sum += A(i, k) * x(k);
+                ASSERT_NEAR(y(i), sum, 1e-12);
+            }
+        }
+}
+
+// 127 * 127 * n overflows 16 bits from the second term and fits in 32 bits:
+// only an int32 accumulator gets these right.
+TEST_P(SimdLevel, Int8DotAccumulatesInInt32) {
+    for (uint64_t n: {1, 15, 64, 100003}) {
+        std::vector<int8_t> x(n, 127), y(n, 127), z(n, -127);
+        EXPECT_EQ(simd::dot(n, x.data(), y.data()), int32_t(16129 * n));
+        EXPECT_EQ(simd::dot(n, x.data(), z.data()), -int32_t(16129 * n));
+    }
+
+    std::vector<int8_t> x(301), y(301);
+    int32_t expected = 0;
+    for (int i = 0; i < 301; i++) {
+        x[i] = int8_t(i % 255 - 127);
+        y[i] = int8_t((i * 7) % 255 - 127);
+        expected += int32_t(x[i]) * y[i];
+    }
+    EXPECT_EQ(simd::dot(301, x.data(), y.data()), expected);
+}
+
+TEST_P(SimdLevel, HalfWidening) {
+    for (uint64_t n: {0, 1, 9, 40}) {
+        auto x = random_vector<float>(n, 3);
+        std::vector<bf16> b(n);
+        std::vector<fp16> h(n);
+        for (uint64_t i = 0; i < n; i++)
+            b[i] = bf16(x.data()[i]), h[i] = fp16(x.data()[i]);
+
+        std::vector<float> out(n);
+        simd::widen(n, b.data(), out.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_EQ(out[i], float(b[i]));
+        simd::widen(n, h.data(), out.data());
+        for (uint64_t i = 0; i < n; i++)
+            ASSERT_EQ(out[i], float(h[i]));
+
+        double dot = 0;
+        for (uint64_t i = 0; i < n; i++)
+            dot += double(float(h[i])) * x.data()[i];
+        EXPECT_NEAR(simd::dot(n, h.data(), x.data()), dot, 1e-5);
+    }
+}
+
+TEST_P(SimdLevel, NaiveProducts) {
+    auto A = random_matrix<float>(37, 23, 1), B = random_matrix<float>(23, 29, 2);
+    auto v = random_vector<float>(23, 3), w = random_vector<float>(37, 4);
+
+    auto C = naive::multiply(A, B);
+    expect_near(C.view(), reference(A.view(), B.view()).view(), tolerance<float>());
+
+    auto At = random_matrix<float>(23, 37, 5);
+    auto Ct = naive::multiply(transpose(At), B);
+    expect_near(Ct.view(), reference(At.view().transpose(), B.view()).view(), tolerance<float>());
+
+    auto Av = naive::multiply(A, v);
+    auto vA = naive::multiply(w, A);
+    auto Av_expected = reference(A.view(), MatrixView<float>(v.data(), 23, 1, 1, 1));
+    auto vA_expected = reference(MatrixView<float>(w.data(), 1, 37, 37, 1), A.view());
+    expect_near(Av.view(), Av_expected.col(1), tolerance<float>());
+    expect_near(vA.view(), vA_expected.row(1), tolerance<float>());
+}
+
+// Sides past MINILA_GEMM_MC and MINILA_GEMM_KC, so several packed panels and
+// partial register tiles are used; operands are strided and transposed views.
+TEST_P(SimdLevel, BlockedGemm) {
+    auto A = random_matrix<float>(150, 270, 1);
+    auto B = random_matrix<float, Layout::ColMajor>(270, 37, 2);
+    auto C = random_matrix<float>(150, 37, 3);
+    auto expected = reference(A.view(), B.view());
+    for (uint64_t i = 1; i <= 150; i++)
+        for (uint64_t j = 1; j <= 37; j++)
+            expected(i, j) = 2 * expected(i, j) - 0.5 * C(i, j);
+
+    blocked::gemm(2.0f, A.view(), B.view(), -0.5f, C.view());
+    expect_near(C.view(), expected.view(), 1e-3);
+
+    auto At = random_matrix<double>(40, 61, 4), Bt = random_matrix<double>(13, 40, 5);
+    Matrix<double> D(61, 13);
+    blocked::gemm(1.0, At.view().transpose(), Bt.view().transpose(), 0.0, D.view());
+    expect_near(D.view(), reference(At.view().transpose(), Bt.view().transpose()).view(), tolerance<double>());
+
+    auto big = random_matrix<double>(30, 30, 6);
+    Matrix<double> E(9, 11);
+    blocked::gemm(1.0, big.block(2, 3, 9, 7), big.block(11, 1, 7, 11), 0.0, E.view());
+    expect_near(E.view(), reference(big.block(2, 3, 9, 7), big.block(11, 1, 7, 11)).view(), tolerance<double>());
+}
+
+TEST_P(SimdLevel, BlockedHalfGemm) {
+    auto Af = random_matrix<float>(33, 70, 1), Bf = random_matrix<float>(70, 21, 2);
+    auto A = to_type<bf16>(Af);
+    auto B = to_type<fp16>(Bf);
+    auto Bh = to_type<bf16>(Bf);
+
+    auto C = blocked::multiply(A, Bh);
+    expect_near(C.view(), reference(A.view(), Bh.view()).view(), 1e-4);
+
+    auto Ah = to_type<fp16>(Af);
+    auto D = blocked::multiply(Ah, B);
+    expect_near(D.view(), reference(Ah.view(), B.view()).view(), 1e-4);
+}
+
+// Every side up to MINILA_BATCHED_SMALL goes through simd::gemm_small, larger
+// items through BLAS.
+TEST_P(SimdLevel, BatchedProducts) {
+    for (uint64_t m: {1, 3, 4, 9})
+        for (uint64_t p: {2, 4, 11}) {
+            std::vector<Matrix<float>> A, B;
+            std::vector<Vector<float>> x;
+            for (uint64_t b = 0; b < 5; b++) {
+                A.push_back(random_matrix<float>(m, p, b));
+                B.push_back(random_matrix<float>(p, 3, b + 10));
+                x.push_back(random_vector<float>(p, b + 20));
+            }
+
+            auto C = batched::multiply(A, B);
+            auto y = batched::multiply(A, x);
+            for (uint64_t b = 0; b < 5; b++) {
+                expect_near(batched::item(C, b), reference(A[b].view(), B[b].view()).view(), tolerance<float>());
+                auto expected = reference(A[b].view(), MatrixView<float>(x[b].data(), p, 1, 1, 1));
+                expect_near(VectorView<float>(y.data() + b * m, m), expected.col(1), tolerance<float>());
+            }
+        }
+}
+
+TEST_P(SimdLevel, QuantizedProducts) {
+    auto A = random_matrix<float>(19, 300, 1), B = random_matrix<float>(300, 7, 2);
+    auto x = random_vector<float>(300, 3);
+
+    auto qA = quantized::quantize(A);
+    auto qB = quantized::quantize<Layout::ColMajor>(B);
+    auto X = Matrix<float>(MatrixView<float>(x.data(), 1, 300, 300, 1));
+    auto qx = quantized::quantize(X);
+
+    // Rescaled int32 dot products of exactly the quantized values.
+    auto C = quantized::multiply(qA, qB);
+    auto y = quantized::multiply(qA, x);
+    for (uint64_t i = 1; i <= 19; i++) {
+        for (uint64_t j = 1; j <= 7; j++) {
+            int64_t dot = 0;
+            for (uint64_t k = 1; k <= 300; k++)
+                dot += int64_t(qA.values(i, k)) * qB.values(k, j);
+            ASSERT_NEAR(C(i, j), double(qA.scales(i)) * qB.scales(j) * dot, 1e-5);
+        }
+
+        int64_t dot = 0;
+        for (uint64_t k = 1; k <= 300; k++)
+            dot += int64_t(qA.values(i, k)) * qx.values(1, k);
+        ASSERT_NEAR(y(i), double(qA.scales(i)) * qx.scales(1) * dot, 1e-5);
+    }
+
+    // And close to the float product: each factor is off by at most half a step.
+    expect_near(C.view(), reference(A.view(), B.view()).view(), 0.2);
+}
+
+INSTANTIATE_TEST_SUITE_P(Levels, SimdLevel,
+                         testing::Values(simd::Level::Scalar, simd::Level::SSE, simd::Level::AVX2,
+                                         simd::Level::AVX512),
+                         level_name);
+
+// 16-bit floats
+
+TEST(Half, RoundTripsEveryValue) {
+    for (uint32_t bits = 0; bits <= 0xFFFF; bits++) {
+        fp16 h;
+        h.bits = uint16_t(bits);
+        bf16 b;
+        b.bits = uint16_t(bits);
+
+        if (std::isnan(float(h)))
+            ASSERT_TRUE(std::isnan(float(fp16(float(h)))));
+        else
+            ASSERT_EQ(fp16(float(h)).bits, h.bits) << std::hex << bits;
+
+        if (std::isnan(float(b)))
+            ASSERT_TRUE(std::isnan(float(bf16(float(b)))));
+        else
+            ASSERT_EQ(bf16(float(b)).bits, b.bits) << std::hex << bits;
+    }
+}
+
+TEST(Half, RoundsToNearestEven) {
+    EXPECT_EQ(float(bf16(1 + 0x1p-8f)), 1.0f);
+    EXPECT_EQ(float(bf16(1 + 3 * 0x1p-8f)), 1 + 0x1p-6f);
+    EXPECT_EQ(float(bf16(1 + 0x1.8p-8f)), 1 + 0x1p-7f);
+    EXPECT_TRUE(std::isinf(float(bf16(std::numeric_limits<float>::max()))));
+    EXPECT_TRUE(std::isnan(float(bf16(std::numeric_limits<float>::quiet_NaN()))));
+
+    EXPECT_EQ(float(fp16(1 + 0x1p-11f)), 1.0f);
+    EXPECT_EQ(float(fp16(1 + 3 * 0x1p-11f)), 1 + 0x1p-9f);
+    EXPECT_EQ(float(fp16(65519.0f)), 65504.0f);
+    EXPECT_TRUE(std::isinf(float(fp16(65520.0f))));
+    EXPECT_EQ(float(fp16(0x1p-24f)), 0x1p-24f);
+    EXPECT_EQ(float(fp16(0x1p-25f)), 0.0f);
+    EXPECT_EQ(float(fp16(3 * 0x1p-25f)), 0x1p-23f);
+    EXPECT_EQ(float(fp16(-2.5f)), -2.5f);
+    EXPECT_TRUE(std::isnan(float(fp16(std::numeric_limits<float>::quiet_NaN()))));
+
+    // Nothing representable is closer than the rounded value.
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> uniform(-60000, 60000);
+    for (int i = 0; i < 100000; i++) {
+        const float x = uniform(generator) * (i % 2 ? 1.0f : 1e-4f);
+        const fp16 h(x);
+        fp16 below, above;
+        below.bits = uint16_t(h.bits - 1), above.bits = uint16_t(h.bits + 1);
+        ASSERT_LE(std::fabs(x - float(h)), std::fabs(x - float(below))) << x;
+        ASSERT_LE(std::fabs(x - float(h)), std::fabs(x - float(above))) << x;
+
+        const bf16 b(x);
+        bf16 b_below, b_above;
+        b_below.bits = uint16_t(b.bits - 1), b_above.bits = uint16_t(b.bits + 1);
+        ASSERT_LE(std::fabs(x - float(b)), std::fabs(x - float(b_below))) << x;
+        ASSERT_LE(std::fabs(x - float(b)), std::fabs(x - float(b_above))) << x;
+    }
+}
+
+// int8 quantization
+
+TEST(Quantized, RoundTripWithinHalfAStep) {
+    auto M = random_matrix<float>(13, 21, 1);
+    auto rows = quantized::quantize(M);
+    auto cols = quantized::quantize<Layout::ColMajor>(M);
+    auto R = quantized::dequantize(rows);
+    auto C = quantized::dequantize(cols);
+
+    for (uint64_t i = 1; i <= 13; i++)
+        for (uint64_t j = 1; j <= 21; j++) {
+            ASSERT_NEAR(R(i, j), M(i, j), rows.scales(i) / 2 + 1e-7);
+            ASSERT_NEAR(C(i, j), M(i, j), cols.scales(j) / 2 + 1e-7);
+        }
+}
+
+TEST(Quantized, EmptyLines) {
+    for (auto [rows, cols]: {std::pair<uint64_t, uint64_t>{5, 0}, {0, 5}}) {
+        Matrix<float> M(rows, cols);
+        auto R = quantized::quantize(M);
+        auto C = quantized::quantize<Layout::ColMajor>(M);
+
+        EXPECT_EQ(R.scales.dimensions(), rows);
+        EXPECT_EQ(C.scales.dimensions(), cols);
+        for (uint64_t i = 0; i < R.scales.dimensions(); i++)
+            EXPECT_EQ(R.scales.data()[i], 0.0f);
+        for (uint64_t i = 0; i < C.scales.dimensions(); i++)
+            EXPECT_EQ(C.scales.data()[i], 0.0f);
+
+        EXPECT_EQ(quantized::dequantize(R).rows(), rows);
+        EXPECT_EQ(quantized::dequantize(C).cols(), cols);
+    }
+}
+
+// Other multiply backends
+
+TEST(Strassen, MatchesDirectProduct) {
+    for (auto [m, p, n]: {std::tuple<uint64_t, uint64_t, uint64_t>{64, 64, 64}, {67, 65, 63}, {33, 80, 17}}) {
+        auto A = random_matrix<double>(m, p, m);
+        auto B = random_matrix<double, Layout::ColMajor>(p, n, n);
+        auto C = strassen::multiply(A, B, 16);
+        expect_near(C.view(), reference(A.view(), B.view()).view(), 1e-9);
+    }
+}
+
+TEST(Blas, ProductsInEveryLayout) {
+    auto A = random_matrix<double, Layout::ColMajor>(21, 14, 1);
+    auto B = random_matrix<double>(14, 9, 2);
+    auto C = blas::multiply(A, B);
+    expect_near(C.view(), reference(A.view(), B.view()).view(), tolerance<double>());
+
+    auto D = blas::multiply(transpose(B), transpose(A));
+    expect_near(D.view(), reference(B.view().transpose(), A.view().transpose()).view(), tolerance<double>());
+}
+
+// Elementwise expressions and layouts
+
+TEST(Expression, SinglePassMatchesElementwise) {
+    auto A = random_matrix<double>(7, 9, 1), B = random_matrix<double>(7, 9, 2), C = random_matrix<double>(7, 9, 3);
+    Matrix<double> E = A + B - C;
+    for (uint64_t i = 1; i <= 7; i++)
+        for (uint64_t j = 1; j <= 9; j++)
+            ASSERT_DOUBLE_EQ(E(i, j), A(i, j) + B(i, j) - C(i, j));
+
+    auto F = to_layout<Layout::ColMajor>(A);
+    for (uint64_t i = 1; i <= 7; i++)
+        for (uint64_t j = 1; j <= 9; j++)
+            ASSERT_EQ(F(i, j), A(i, j));
+}
+
+// Sparse matrices
+
+TEST(Sparse, BuilderSortsAndMergesDuplicates) {
+    std::vector<Triplet<double>> triplets = {{3, 2, 1.5}, {1, 4, 2}, {3, 1, -1}, {1, 4, 0.5}, {2, 2, 7}};
+    SparseMatrix<double> csr(3, 4, triplets);
+    SparseMatrix<double, Layout::ColMajor> csc(3, 4, triplets);
+
+    EXPECT_EQ(csr.nonzeros(), 4u);
+    EXPECT_EQ(csc.nonzeros(), 4u);
+    EXPECT_EQ(csr(1, 4), 2.5);
+    EXPECT_EQ(csc(1, 4), 2.5);
+    EXPECT_EQ(csr(3, 1), -1);
+    EXPECT_EQ(csr(1, 1), 0);
+
+    const uint64_t offsets[] = {0, 1, 2, 4}, indices[] = {3, 1, 0, 1};
+    for (int k = 0; k < 4; k++)
+        EXPECT_EQ(csr.offsets()[k], offsets[k]);
+    for (int e = 0; e < 4; e++)
+        EXPECT_EQ(csr.indices()[e], indices[e]);
+
+    EXPECT_THROW(SparseMatrix<double>(3, 4, {{4, 1, 1.0}}), std::invalid_argument);
+    EXPECT_THROW(SparseMatrix<double>(3, 4, {{1, 0, 1.0}}), std::invalid_argument);
+
+    auto dense = csr.dense();
+    SparseMatrix<double, Layout::ColMajor> back(dense);
+    auto converted = to_layout<Layout::ColMajor>(csr);
+    for (uint64_t i = 1; i <= 3; i++)
+        for (uint64_t j = 1; j <= 4; j++) {
+            EXPECT_EQ(back(i, j), dense(i, j));
+            EXPECT_EQ(converted(i, j), csc(i, j));
+        }
+}
+
+template<Layout L>
+void check_sparse_products() {
+    auto dense = random_matrix<double>(40, 30, 1);
+    for (uint64_t i = 1; i <= 40; i++)
+        for (uint64_t j = 1; j <= 30; j++)
+            if ((i * 7 + j * 3) % 5)
+                dense(i, j) = 0;
+
+    SparseMatrix<double, L> S(dense);
+    auto x = random_vector<double>(30, 2), y = random_vector<double>(40, 3);
+    auto M = random_matrix<double>(30, 6, 4), N = random_matrix<double>(5, 40, 5);
+
+    auto Sx = sparse::multiply(S, x);
+    auto yS = sparse::multiply(y, S);
+    auto SM = sparse::multiply(S, M);
+    auto NS = sparse::multiply(N, S);
+
+    expect_near(Sx.view(), reference(dense.view(), MatrixView<double>(x.data(), 30, 1, 1, 1)).col(1),
+                tolerance<double>());
+    expect_near(yS.view(), reference(MatrixView<double>(y.data(), 1, 40, 40, 1), dense.view()).row(1),
+                tolerance<double>());
+    expect_near(SM.view(), reference(dense.view(), M.view()).view(), tolerance<double>());
+    expect_near(NS.view(), reference(N.view(), dense.view()).view(), tolerance<double>());
+}
+
+TEST(Sparse, CsrProducts) {
+    check_sparse_products<Layout::RowMajor>();
+}
+
+TEST(Sparse, CscProducts) {
+    check_sparse_products<Layout::ColMajor>();
+}
+
+// Structured matrices
+
+TEST(Structured, SymmetricAndTriangular) {
+    auto dense = random_matrix<double>(12, 12, 1);
+    for (uint64_t i = 1; i <= 12; i++) {
+        dense(i, i) += 12;
+        for (uint64_t j = 1; j < i; j++)
+            dense(i, j) = dense(j, i);
+    }
+    auto v = random_vector<double>(12, 2);
+    auto V = MatrixView<double>(v.data(), 12, 1, 1, 1);
+
+    SymmetricMatrix<double> S(dense);
+    expect_near(structured::multiply(S, v).view(), reference(dense.view(), V).col(1), tolerance<double>());
+
+    TriangularMatrix<double> U(dense, Triangle::Upper);
+    auto x = structured::solve(U, v);
+    auto Ux = structured::multiply(U, x);
+    for (uint64_t i = 1; i <= 12; i++)
+        ASSERT_NEAR(Ux(i), v(i), 1e-12);
+}
+
+// LAPACK wrappers
+
+TEST(Lapack, LuSolveDetInverse) {
+    const uint64_t n = 9;
+    auto A = random_matrix<double, Layout::ColMajor>(n, n, 1);
+    auto b = random_vector<double>(n, 2);
+    auto B = random_matrix<double>(n, 3, 3);
+
+    auto P = lu(A);
+    ASSERT_EQ(P.info, 0);
+    auto x = P.solve(b);
+    auto X = P.solve(B);
+    expect_near(reference(A.view(), MatrixView<double>(x.data(), n, 1, 1, 1)).col(1), b.view(), 1e-9);
+    auto AX = reference(A.view(), X.view());
+    for (uint64_t i = 1; i <= n; i++)
+        for (uint64_t j = 1; j <= 3; j++)
+            ASSERT_NEAR(AX(i, j), B(i, j), 1e-9);
+
+    auto I = P.inverse();
+    auto AI = reference(A.view(), I.view());
+    for (uint64_t i = 1; i <= n; i++)
+        for (uint64_t j = 1; j <= n; j++)
+            ASSERT_NEAR(AI(i, j), i == j ? 1 : 0, 1e-9);
+
+    // det(2x2) by hand, with a row swap.
+    Matrix<double> T(2, 2);
+    T(1, 1) = 1, T(1, 2) = 2, T(2, 1) = 3, T(2, 2) = 4;
+    EXPECT_NEAR(lu(T).det(), -2, 1e-12);
+
+    auto c = Vector<double>(b.view().segment(1, 2));
+    auto y = linsolve(T, c);
+    EXPECT_NEAR(y(1) + 2 * y(2), b(1), 1e-12);
+    EXPECT_NEAR(3 * y(1) + 4 * y(2), b(2), 1e-12);
+}
+
+TEST(Lapack, CholeskyAndQr) {
+    const uint64_t n = 8;
+    auto G = random_matrix<double>(n, n, 1);
+    auto A = reference(G.view().transpose(), G.view());
+    for (uint64_t i = 1; i <= n; i++)
+        A(i, i) += 1;
+    auto b = random_vector<double>(n, 2);
+
+    auto C = cholesky(A);
+    ASSERT_EQ(C.info, 0);
+    expect_near(reference(A.view(), MatrixView<double>(C.solve(b).data(), n, 1, 1, 1)).col(1), b.view(), 1e-9);
+    EXPECT_NEAR(C.det(), lu(A).det(), 1e-9 * std::fabs(C.det()));
+
+    auto M = random_matrix<double, Layout::ColMajor>(12, 5, 3);
+    for (bool pivoting: {false, true}) {
+        auto F = qr(M, pivoting);
+        ASSERT_EQ(F.info, 0);
+        auto Q = F.Q();
+        auto QtQ = reference(Q.view().transpose(), Q.view());
+        for (uint64_t i = 1; i <= 5; i++)
+            for (uint64_t j = 1; j <= 5; j++)
+                ASSERT_NEAR(QtQ(i, j), i == j ? 1 : 0, 1e-12);
+
+        // Consistent system: the least-squares solution is exact.
+        auto x = random_vector<double>(5, 4);
+        auto Mx = reference(M.view(), MatrixView<double>(x.data(), 5, 1, 1, 1));
+        auto rhs = Vector<double>(Mx.col(1));
+        expect_near(F.solve(rhs).view(), x.view(), 1e-9);
+    }
+}
+
+TEST(Lapack, LeastSquares) {
+    auto A = random_matrix<double>(15, 4, 1);
+    auto x = random_vector<double>(4, 2);
+    auto b = Vector<double>(reference(A.view(), MatrixView<double>(x.data(), 4, 1, 1, 1)).col(1));
+
+    expect_near(lstsq(A, b).view(), x.view(), 1e-9);
+    expect_near(lstsq(A, b, LstsqDriver::SVD).view(), x.view(), 1e-9);
+
+    // Rank deficient: a repeated column. The SVD driver returns a solution whose
+    // residual is orthogonal to the range of A.
+    for (uint64_t i = 1; i <= 15; i++)
+        A(i, 4) = A(i, 1);
+    auto noisy = random_vector<double>(15, 3);
+    auto y = lstsq(A, noisy, LstsqDriver::SVD);
+    auto Ay = reference(A.view(), MatrixView<double>(y.data(), 4, 1, 1, 1));
+    for (uint64_t j = 1; j <= 4; j++) {
+        double dot = 0;
+        for (uint64_t i = 1; i <= 15; i++)
+            dot += A(i, j) * (Ay(i, 1) - noisy(i));
+        ASSERT_NEAR(dot, 0, 1e-9);
+    }
+    EXPECT_NEAR(y(1), y(4), 1e-9);
+}
+
+TEST(Lapack, SvdOptions) {
+    auto M = random_matrix<double>(9, 6, 1);
+    SVDWorkspace<double> workspace;
+
+    auto reference_values = svd(M).s;
+    for (auto driver: {SVDDriver::QR, SVDDriver::DivideAndConquer}) {
+        auto thin = svd(M, SVDOptions{SVDJob::Thin, driver}, workspace);
+        ASSERT_EQ(thin.info, 0);
+        ASSERT_EQ(thin.U.cols(), 6u);
+
+        // U S V^T rebuilds M.
+        Matrix<double> US(thin.U);
+        for (uint64_t i = 1; i <= 9; i++)
+            for (uint64_t j = 1; j <= 6; j++)
+                US(i, j) *= thin.s(j);
+        expect_near(M.view(), reference(US.view(), thin.V.view()).view(), 1e-10);
+
+        auto values = svd(M, SVDOptions{SVDJob::Values, driver}, workspace);
+        for (uint64_t k = 1; k <= 6; k++)
+            ASSERT_NEAR(values.s(k), reference_values(k), 1e-10);
+    }
+
+    auto low = reference(random_matrix<double>(9, 2, 2).view(), random_matrix<double>(2, 6, 3).view());
+    EXPECT_EQ(rank(low), 2u);
+}
+
+TEST(Lapack, RandomizedSvd) {
+    // Rank 5 exactly: the sketch captures its whole range.
+    auto M = reference(random_matrix<double>(60, 5, 1).view(), random_matrix<double>(5, 40, 2).view());
+    auto exact = svd(M, SVDOptions{SVDJob::Values});
+    auto approx = randomized::svd(M, 5);
+    ASSERT_EQ(approx.info, 0);
+    for (uint64_t i = 1; i <= 5; i++)
+        ASSERT_NEAR(approx.s(i), exact.s(i), 1e-9 * exact.s(1));
+}
+
+TEST(Lapack, SymmetricEigen) {
+    const uint64_t n = 10;
+    auto G = random_matrix<double, Layout::ColMajor>(n, n, 1);
+    Matrix<double, 0, 0, Layout::ColMajor> A(n, n);
+    for (uint64_t i = 1; i <= n; i++)
+        for (uint64_t j = 1; j <= n; j++)
+            A(i, j) = G(i, j) + G(j, i);
+
+    auto all = eig_sym(A);
+    ASSERT_EQ(all.info, 0);
+    ASSERT_EQ(all.values.dimensions(), n);
+    auto AV = reference(A.view(), all.vectors.view());
+    for (uint64_t j = 1; j <= n; j++)
+        for (uint64_t i = 1; i <= n; i++)
+            ASSERT_NEAR(AV(i, j), all.values(j) * all.vectors(i, j), 1e-9);
+
+    auto top = eig_sym(A, EigenOptions{true, EigenRange::Index, n - 2, n});
+    ASSERT_EQ(top.values.dimensions(), 3u);
+    for (uint64_t k = 1; k <= 3; k++)
+        ASSERT_NEAR(top.values(k), all.values(n - 3 + k), 1e-9);
+
+    // Bounds halfway between eigenvalues, so rounding cannot move one across.
+    const double lower = (all.values(2) + all.values(3)) / 2, upper = (all.values(6) + all.values(7)) / 2;
+    auto window = eig_sym(A, EigenOptions{false, EigenRange::Value, 1, 1, lower, upper});
+    ASSERT_EQ(window.values.dimensions(), 4u);
+    ASSERT_NEAR(window.values(1), all.values(3), 1e-9);
+}
+
+// Fused BLAS kernels and the edge cases they are meant to survive
+
+TEST(Blas, CosineSurvivesOverflowAndUnderflow) {
+    for (double magnitude: {1.0, 1e160, 1e-170}) {
+        Vector<double> x(37), y(37);
+        for (uint64_t i = 1; i <= 37; i++)
+            x(i) = magnitude * double(i), y(i) = magnitude * double(38 - i);
+
+        EXPECT_NEAR(blas::cosine(x, y), 0.52, 1e-12) << magnitude;
+        EXPECT_NEAR(blas::angle(x, y), std::acos(0.52), 1e-12) << magnitude;
+        EXPECT_NEAR(blas::cosine(x.view(), y.view().segment(1, 37)), 0.52, 1e-12) << magnitude;
+    }
+
+    Vector<float> x(37), y(37);
+    for (uint64_t i = 1; i <= 37; i++)
+        x(i) = 3e19f * float(i), y(i) = 3e19f * float(38 - i);
+    EXPECT_NEAR(blas::cosine(x, y), 0.52f, 1e-5f);
+    EXPECT_NEAR(blas::angle(x, x), 0.0f, 1e-3f);
+}
+
+TEST(Blas, NormalizeSurvivesOverflow) {
+    Vector<float> x(50);
+    for (uint64_t i = 1; i <= 50; i++)
+        x(i) = 3e19f;
+
+    const float norm = blas::normalize(x);
+    EXPECT_TRUE(std::isfinite(norm));
+    EXPECT_NEAR(blas::nrm2(x), 1.0f, 1e-5f);
+
+    Vector<double> zero(4);
+    EXPECT_EQ(blas::normalize(zero), 0.0);
+    EXPECT_EQ(zero(1), 0.0);
+}
+
+TEST(Blas, OutputParameterProductsRejectAliasing) {
+    auto A = random_matrix<double>(8, 8, 1), B = random_matrix<double>(8, 8, 2);
+
+    EXPECT_THROW(blas::gemm_into(A, A, B), std::invalid_argument);
+    EXPECT_THROW(blas::gemm_into(A.block(1, 1, 4, 4), A.block(3, 3, 4, 4), B.block(1, 1, 4, 4)),
+                 std::invalid_argument);
+    EXPECT_THROW(blas::gemv_into(A.col(2), A.block(1, 1, 8, 8), B.col(1)), std::invalid_argument);
+
+    // Disjoint blocks of one matrix are fine.
+    auto expected = reference(A.block(1, 1, 4, 8), B.view());
+    blas::gemm_into(A.block(5, 1, 4, 8), A.block(1, 1, 4, 8), B.view());
+    expect_near(A.block(5, 1, 4, 8), expected.view(), tolerance<double>());
+}
+
+// Runtime
+
+TEST(Runtime, IntegrationIsSerialUnlessAsked) {
+    int calls = 0;
+    auto counted = [&](double x) {
+        calls++;
+        return x * x;
+    };
+
+    const double serial = integration::simpson(counted, 0.0, 1.0, 1000u);
+    EXPECT_EQ(calls, 3000);
+    EXPECT_NEAR(serial, 1.0 / 3, 1e-12);
+
+    auto square = [](double x) { return x * x; };
+    EXPECT_NEAR(integration::simpson(square, 0.0, 1.0, 1000u, true), serial, 1e-12);
+    EXPECT_NEAR(integration::trapezium(square, 0.0, 1.0, 1000u, true),
+                integration::trapezium(square, 0.0, 1.0, 1000u), 1e-12);
+}
+
+TEST(Runtime, ArenaStaysWithinCapacity) {
+    Arena arena(1 << 16);
+    {
+        ArenaScope scope(arena);
+        for (uint64_t it = 0; it < 200; it++) {
+            Matrix<double> A(10 + it % 7, 20 + it % 5), B(20 + it % 5, 3);
+            auto C = blas::multiply(A, B);
+            ASSERT_LE(arena.cached(), arena.capacity());
+        }
+        { Matrix<double> huge(200, 200); }
+        EXPECT_LE(arena.cached(), arena.capacity());
+    }
+    EXPECT_GT(arena.cached(), 0u);
+
+    arena.release();
+    EXPECT_EQ(arena.cached(), 0u);
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}